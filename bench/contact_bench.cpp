@@ -0,0 +1,266 @@
+// Microbenchmarks of the DatabaseManager API and model population over
+// generated books of several sizes, written as JSON so that runs before
+// and after a Qt or SQLite upgrade can be diffed.
+//
+// Usage: contact_bench [--sizes 10000,100000,1000000] [--engine sqlite|memory]
+//                      [--output results.json]
+//
+// Every size gets a fresh database in a scratch directory. Timings are
+// wall clock; where a benchmark is repeated the best run is kept.
+
+#include "contactgenerator.h"
+#include "contacttablemodel.h"
+#include "databasemanager.h"
+#include "memorystorageengine.h"
+#include "sqlitestorageengine.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <limits>
+#include <memory>
+
+namespace {
+
+// Rows per addContacts() call while loading a book
+const int LoadChunkSize = 10000;
+// Same cap as the search box
+const int SearchLimit = 1000;
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// Per-row debug lines would dominate the timings
+void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    if (type == QtDebugMsg || type == QtInfoMsg) return;
+    err() << message << Qt::endl;
+}
+
+QString sqliteVersion()
+{
+    QString version;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "bench-version");
+        database.setDatabaseName(":memory:");
+        if (database.open()) {
+            QSqlQuery query(database);
+            if (query.exec("SELECT sqlite_version()") && query.next()) {
+                version = query.value(0).toString();
+            }
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("bench-version");
+    return version;
+}
+
+/**
+ * Collects results for one book size.
+ */
+class Recorder
+{
+public:
+    Recorder(int rows, QJsonArray *results) : m_rows(rows), m_results(results) {}
+
+    void record(const QString &name, qint64 operations, qint64 nanoseconds,
+                const QString &unit = QStringLiteral("ops"))
+    {
+        nanoseconds = qMax<qint64>(1, nanoseconds);
+        const double perSecond = operations * 1e9 / nanoseconds;
+
+        QJsonObject result;
+        result["rows"] = m_rows;
+        result["benchmark"] = name;
+        result["operations"] = operations;
+        result["unit"] = unit;
+        result["total_ms"] = nanoseconds / 1e6;
+        result["mean_us"] = operations > 0 ? nanoseconds / 1e3 / operations : 0.0;
+        result["per_second"] = perSecond;
+        m_results->append(result);
+
+        err() << QString("%1 rows  %2  %3 %4/s")
+                     .arg(m_rows, 8).arg(name, -24).arg(perSecond, 12, 'f', 0).arg(unit)
+              << Qt::endl;
+    }
+
+private:
+    int m_rows;
+    QJsonArray *m_results;
+};
+
+std::unique_ptr<StorageEngine> createEngine(const QString &engine, const QString &directory)
+{
+    if (engine == "memory") {
+        return std::make_unique<MemoryStorageEngine>(directory + "/contacts.log");
+    }
+    return std::make_unique<SqliteStorageEngine>(directory + "/contacts.db");
+}
+
+bool benchmarkSize(int rows, const QString &engine, QJsonArray *results)
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        err() << "Cannot create a scratch directory" << Qt::endl;
+        return false;
+    }
+
+    DatabaseManager db;
+    db.setStorageEngine(createEngine(engine, dir.path()));
+    if (!db.connectToDatabase(QString(), QString(), QString(), QString()) || !db.createTable()) {
+        err() << "Database setup failed: " << db.lastError() << Qt::endl;
+        return false;
+    }
+
+    Recorder recorder(rows, results);
+    ContactGenerator generator;
+    QElapsedTimer timer;
+
+    // Bulk load, generated in chunks so a million rows never sit in memory twice
+    qint64 loadNs = 0;
+    for (int loaded = 0; loaded < rows; loaded += LoadChunkSize) {
+        const QVector<Contact> chunk = generator.generate(qMin(LoadChunkSize, rows - loaded));
+        timer.start();
+        if (db.addContacts(chunk) < 0) {
+            err() << "Load failed: " << db.lastError() << Qt::endl;
+            return false;
+        }
+        loadNs += timer.nsecsElapsed();
+    }
+    recorder.record("addContacts", rows, loadNs, "rows");
+
+    // Single inserts on top of the loaded book, each its own transaction
+    const int singleInserts = qMin(rows, 2000);
+    const QVector<Contact> extra = generator.generate(singleInserts);
+    timer.start();
+    for (const Contact &contact : extra) {
+        db.addContact(contact);
+    }
+    recorder.record("addContact", singleInserts, timer.nsecsElapsed());
+    const int total = rows + singleInserts;
+
+    QVector<Contact> all;
+    qint64 bestNs = std::numeric_limits<qint64>::max();
+    for (int run = 0; run < 3; ++run) {
+        timer.start();
+        all = db.getAllContacts();
+        bestNs = qMin(bestNs, timer.nsecsElapsed());
+    }
+    recorder.record("getAllContacts", all.size(), bestNs, "rows");
+
+    const QStringList terms = generator.sampleSearchTerms(200);
+    int matches = 0;
+    timer.start();
+    for (const QString &term : terms) {
+        matches += db.searchContacts(term, SearchLimit).size();
+    }
+    recorder.record("searchContacts", terms.size(), timer.nsecsElapsed());
+    Q_UNUSED(matches)
+
+    // Ids run from 1 to total in both engines
+    const int lookups = 20000;
+    QRandomGenerator rng(7);
+    timer.start();
+    for (int i = 0; i < lookups; ++i) {
+        db.getContact(1 + rng.bounded(total));
+    }
+    recorder.record("getContact", lookups, timer.nsecsElapsed());
+
+    db.setContactCacheBudget(0);
+    timer.start();
+    for (int i = 0; i < lookups; ++i) {
+        db.getContact(1 + rng.bounded(total));
+    }
+    recorder.record("getContact_uncached", lookups, timer.nsecsElapsed());
+
+    // What MainWindow::displayContacts() does with a result set, followed
+    // by the view reading every visible cell of the first screen
+    ContactTableModel model(&db);
+    timer.start();
+    model.setContacts(all);
+    const int visible = qMin(model.rowCount(), 50);
+    for (int row = 0; row < visible; ++row) {
+        for (int column = 0; column < ContactTableModel::ColumnCount; ++column) {
+            model.data(model.index(row, column));
+        }
+    }
+    recorder.record("model_setContacts", all.size(), timer.nsecsElapsed(), "rows");
+
+    // Paged mode: first page only, as after connecting
+    timer.start();
+    model.reload();
+    for (int row = 0; row < qMin(model.rowCount(), 50); ++row) {
+        for (int column = 0; column < ContactTableModel::ColumnCount; ++column) {
+            model.data(model.index(row, column));
+        }
+    }
+    recorder.record("model_reload", 1, timer.nsecsElapsed());
+
+    db.disconnectFromDatabase();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    qInstallMessageHandler(quietMessageHandler);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma-separated book sizes.", "list", "10000,100000,1000000");
+    QCommandLineOption engineOption("engine", "sqlite or memory.", "name", "sqlite");
+    QCommandLineOption outputOption("output", "JSON file (default: stdout).", "file");
+    parser.addOptions({sizesOption, engineOption, outputOption});
+    parser.process(app);
+
+    const QString engine = parser.value(engineOption);
+    if (engine != "sqlite" && engine != "memory") {
+        err() << "Unknown engine: " << engine << Qt::endl;
+        return 1;
+    }
+
+    QJsonArray results;
+    for (const QString &size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int rows = size.trimmed().toInt();
+        if (rows <= 0) {
+            err() << "Bad size: " << size << Qt::endl;
+            return 1;
+        }
+        if (!benchmarkSize(rows, engine, &results)) return 1;
+    }
+
+    QJsonObject report;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qt_version"] = QString(qVersion());
+    report["sqlite_version"] = sqliteVersion();
+    report["engine"] = engine;
+    report["cpu"] = QSysInfo::currentCpuArchitecture();
+    report["os"] = QSysInfo::prettyProductName();
+    report["results"] = results;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            err() << "Cannot write " << file.fileName() << ": " << file.errorString() << Qt::endl;
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
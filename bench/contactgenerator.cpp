@@ -0,0 +1,139 @@
+#include "contactgenerator.h"
+#include <cmath>
+
+namespace {
+
+const char *const FirstNames[] = {
+    "James", "Maria", "Wei", "Fatima", "John", "Sofia", "Mohammed", "Anna", "Hiroshi", "Olga",
+    "David", "Laura", "José", "Chloé", "Liam", "Aisha", "Noah", "Emma", "Lukas", "Mia",
+    "Carlos", "Yuki", "Ivan", "Zoë", "Pierre", "Ana", "Ahmed", "Elena", "Raj", "Priya",
+    "Björn", "Ingrid", "Kwame", "Amara", "Mateo", "Lucía", "伟", "芳", "Дмитрий", "Наталья"
+};
+const char *const LastNames[] = {
+    "Smith", "Garcia", "Chen", "Khan", "Müller", "Rossi", "Johnson", "Kim", "Nguyen", "Ivanova",
+    "Williams", "Martínez", "Wang", "Ali", "Schmidt", "Bianchi", "Brown", "Park", "Tran", "Petrov",
+    "O'Brien", "Fernández", "Li", "Hassan", "Schneider", "Romano", "Jones", "Lee", "Pham", "Sokolov",
+    "Van der Berg", "Dubois", "Zhang", "Mensah", "Okafor", "Silva", "Santos", "王", "李", "Кузнецов"
+};
+// City and country at the same index belong together
+const char *const Cities[] = {
+    "New York", "London", "Berlin", "São Paulo", "Shanghai", "Lagos", "Mumbai", "Tokyo",
+    "Paris", "Madrid", "Moscow", "Toronto", "Sydney", "Mexico City", "Seoul", "Cairo",
+    "Zürich", "Stockholm", "Accra", "Buenos Aires", "Kraków", "Lisbon", "Dublin", "Nairobi"
+};
+const char *const Countries[] = {
+    "United States", "United Kingdom", "Germany", "Brazil", "China", "Nigeria", "India", "Japan",
+    "France", "Spain", "Russia", "Canada", "Australia", "Mexico", "South Korea", "Egypt",
+    "Switzerland", "Sweden", "Ghana", "Argentina", "Poland", "Portugal", "Ireland", "Kenya"
+};
+const char *const Domains[] = {
+    "gmail.com", "outlook.com", "yahoo.com", "example.org", "mail.ru", "qq.com", "web.de", "icloud.com"
+};
+
+constexpr int FirstNameCount = int(sizeof(FirstNames) / sizeof(FirstNames[0]));
+constexpr int LastNameCount = int(sizeof(LastNames) / sizeof(LastNames[0]));
+constexpr int CityCount = int(sizeof(Cities) / sizeof(Cities[0]));
+constexpr int DomainCount = int(sizeof(Domains) / sizeof(Domains[0]));
+
+QString asciiLocalPart(const QString &text)
+{
+    QString result;
+    for (QChar c : text.normalized(QString::NormalizationForm_D)) {
+        if (c.isLetterOrNumber() && c.unicode() < 128) result.append(c.toLower());
+    }
+    return result;
+}
+
+} // namespace
+
+ContactGenerator::ContactGenerator(quint32 seed)
+    : m_rng(seed)
+    , m_generated(0)
+{
+}
+
+QString ContactGenerator::pick(const char *const *values, int count)
+{
+    return QString::fromUtf8(values[m_rng.bounded(count)]);
+}
+
+int ContactGenerator::skewedIndex(int count)
+{
+    // Inverse CDF of a power law over [0, count)
+    const double u = m_rng.generateDouble();
+    return qMin(count - 1, int(count * std::pow(u, 2.5)));
+}
+
+Contact ContactGenerator::next()
+{
+    const qint64 serial = m_generated++;
+
+    Contact contact;
+    if (serial > 0 && m_rng.bounded(20) == 0) {
+        // A near-duplicate of the previous original: same person, other data entry
+        contact = m_lastOriginal;
+        contact.id = -1;
+        contact.email = contact.email.toUpper();
+        contact.phone = contact.phone.remove(' ');
+        return contact;
+    }
+
+    contact.firstName = pick(FirstNames, FirstNameCount);
+    contact.lastName = pick(LastNames, LastNameCount);
+
+    QString local = asciiLocalPart(contact.firstName) + "." + asciiLocalPart(contact.lastName);
+    if (local.size() < 3) local = "user";
+    contact.email = QString("%1%2@%3").arg(local).arg(serial).arg(pick(Domains, DomainCount));
+
+    // Half international, half local formatting
+    const int area = 200 + m_rng.bounded(800);
+    const int number = m_rng.bounded(10000000);
+    contact.phone = m_rng.bounded(2) == 0
+        ? QString("+1 %1 %2").arg(area).arg(number, 7, 10, QChar('0'))
+        : QString("(%1) %2-%3").arg(area).arg(number / 10000, 3, 10, QChar('0'))
+              .arg(number % 10000, 4, 10, QChar('0'));
+
+    // A few contacts have no address at all
+    if (m_rng.bounded(10) != 0) {
+        const int place = skewedIndex(CityCount);
+        contact.city = QString::fromUtf8(Cities[place]);
+        contact.country = QString::fromUtf8(Countries[place]);
+    }
+
+    m_lastOriginal = contact;
+    return contact;
+}
+
+QVector<Contact> ContactGenerator::generate(int count)
+{
+    QVector<Contact> contacts;
+    contacts.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        contacts.append(next());
+    }
+    return contacts;
+}
+
+QStringList ContactGenerator::sampleSearchTerms(int count)
+{
+    QStringList terms;
+    terms.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        switch (m_rng.bounded(4)) {
+        case 0:
+            terms.append(pick(FirstNames, FirstNameCount));
+            break;
+        case 1:
+            // Prefix, as typed into the search box
+            terms.append(pick(LastNames, LastNameCount).left(3));
+            break;
+        case 2:
+            terms.append(pick(FirstNames, FirstNameCount) + " " + pick(LastNames, LastNameCount));
+            break;
+        default:
+            terms.append(QString::fromUtf8(Cities[skewedIndex(CityCount)]));
+            break;
+        }
+    }
+    return terms;
+}
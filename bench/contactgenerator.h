@@ -0,0 +1,41 @@
+#ifndef CONTACTGENERATOR_H
+#define CONTACTGENERATOR_H
+
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+#include "contact.h"
+
+/**
+ * @brief Deterministic source of realistic-looking contacts
+ *
+ * The same seed always yields the same sequence, so runs on different
+ * machines or Qt/SQLite versions load identical books. Names come from
+ * several scripts (diacritics, CJK, Cyrillic), addresses follow a skewed
+ * distribution so a few cities dominate as in real address books, and
+ * email and phone formats vary the way imported data does. About one
+ * contact in twenty reuses an earlier person's name with a different
+ * spelling of the email, to give duplicate detection something to find.
+ */
+class ContactGenerator
+{
+public:
+    explicit ContactGenerator(quint32 seed = 42);
+
+    Contact next();
+    QVector<Contact> generate(int count);
+
+    // Search terms that occur in generated books, for query benchmarks
+    QStringList sampleSearchTerms(int count);
+
+private:
+    QRandomGenerator m_rng;
+    qint64 m_generated;
+    Contact m_lastOriginal;
+
+    QString pick(const char *const *values, int count);
+    // Index skewed towards the front: roughly Zipf-distributed
+    int skewedIndex(int count);
+};
+
+#endif // CONTACTGENERATOR_H
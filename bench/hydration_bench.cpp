@@ -0,0 +1,113 @@
+// Compares row hydration through QtSql with the native sqlite3 reader.
+//
+// Usage: hydration_bench [rows]
+
+#include "databasemanager.h"
+#include "nativecontactreader.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace {
+
+QVector<Contact> makeContacts(int count)
+{
+    static const char *const firstNames[] = {"Alexander", "Maria", "Wei", "Fatima", "John", "Sofia"};
+    static const char *const lastNames[] = {"Smith", "Garcia", "Chen", "Khan", "Müller", "Rossi"};
+    static const char *const cities[] = {"Berlin", "New York", "Shanghai", "Lagos", "São Paulo"};
+    static const char *const countries[] = {"Germany", "United States", "China", "Nigeria", "Brazil"};
+
+    QRandomGenerator rng(42);
+    QVector<Contact> contacts;
+    contacts.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Contact contact;
+        contact.firstName = QString::fromUtf8(firstNames[rng.bounded(6)]);
+        contact.lastName = QString::fromUtf8(lastNames[rng.bounded(6)]) + QString::number(i);
+        contact.email = QString("user%1@example.com").arg(i);
+        contact.phone = QString("+1 555 %1").arg(rng.bounded(10000000), 7, 10, QChar('0'));
+        int place = rng.bounded(5);
+        contact.city = QString::fromUtf8(cities[place]);
+        contact.country = QString::fromUtf8(countries[place]);
+        contacts.append(contact);
+    }
+    return contacts;
+}
+
+// Best of several runs, in rows per second
+double measureGetAll(DatabaseManager &db, int runs)
+{
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        int rows = db.getAllContacts().size();
+        qint64 ns = qMax<qint64>(1, timer.nsecsElapsed());
+        best = qMax(best, rows * 1e9 / ns);
+    }
+    return best;
+}
+
+double measureGetContact(DatabaseManager &db, int rowCount, int lookups)
+{
+    QRandomGenerator rng(7);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < lookups; ++i) {
+        db.getContact(1 + rng.bounded(rowCount));
+    }
+    return lookups * 1e9 / qMax<qint64>(1, timer.nsecsElapsed());
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int rowCount = argc > 1 ? QString(argv[1]).toInt() : 100000;
+
+    // DatabaseManager opens contacts.db in the working directory
+    QTemporaryDir dir;
+    if (!dir.isValid() || !QDir::setCurrent(dir.path())) {
+        out << "Cannot create a scratch directory\n";
+        return 1;
+    }
+
+    DatabaseManager db;
+    if (!db.connectToDatabase("localhost", "contacts", "bench", QString()) || !db.createTable()) {
+        out << "Database setup failed: " << db.lastError() << "\n";
+        return 1;
+    }
+    db.addContacts(makeContacts(rowCount));
+    // Measure the storage path, not the contact cache
+    db.setContactCacheBudget(0);
+
+    out << "rows: " << rowCount << "\n";
+
+    db.setNativeReadsEnabled(false);
+    double qtAll = measureGetAll(db, 5);
+    double qtGet = measureGetContact(db, rowCount, 20000);
+    out << QString("QtSql   getAllContacts: %1 rows/s  getContact: %2 ops/s\n")
+               .arg(qtAll, 0, 'f', 0).arg(qtGet, 0, 'f', 0);
+
+    if (!NativeContactReader::isAvailable()) {
+        out << "native  not built (configure with CONTACTMANAGER_NATIVE_SQLITE and SQLite3)\n";
+        return 0;
+    }
+
+    db.setNativeReadsEnabled(true);
+    double nativeAll = measureGetAll(db, 5);
+    double nativeGet = measureGetContact(db, rowCount, 20000);
+    out << QString("native  getAllContacts: %1 rows/s  getContact: %2 ops/s\n")
+               .arg(nativeAll, 0, 'f', 0).arg(nativeGet, 0, 'f', 0);
+    out << QString("speedup getAllContacts: %1x  getContact: %2x\n")
+               .arg(nativeAll / qtAll, 0, 'f', 2).arg(nativeGet / qtGet, 0, 'f', 2);
+
+    db.disconnectFromDatabase();
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Compares the heap footprint of a QVector<Contact> result set with the
+// same rows held in a ContactStore.
+//
+// Usage: memory_bench [rows]
+//
+// On glibc, malloc and friends are wrapped to count allocations and live
+// bytes (as reported by malloc_usable_size, so allocator rounding is
+// included). Elsewhere only timings are reported.
+
+#include "contact.h"
+#include "contactstore.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <atomic>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+}
+
+namespace {
+std::atomic<qint64> allocationCount(0);
+std::atomic<qint64> liveBytes(0);
+}
+
+extern "C" void *malloc(size_t size)
+{
+    void *pointer = __libc_malloc(size);
+    if (pointer) {
+        ++allocationCount;
+        liveBytes += malloc_usable_size(pointer);
+    }
+    return pointer;
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    void *pointer = __libc_calloc(count, size);
+    if (pointer) {
+        ++allocationCount;
+        liveBytes += malloc_usable_size(pointer);
+    }
+    return pointer;
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    const qint64 before = pointer ? qint64(malloc_usable_size(pointer)) : 0;
+    void *result = __libc_realloc(pointer, size);
+    if (result) {
+        ++allocationCount;
+        liveBytes += qint64(malloc_usable_size(result)) - before;
+    }
+    return result;
+}
+
+extern "C" void free(void *pointer)
+{
+    if (pointer) liveBytes -= malloc_usable_size(pointer);
+    __libc_free(pointer);
+}
+
+#define HAVE_ALLOCATION_COUNTERS 1
+#endif
+
+namespace {
+
+struct HeapSnapshot {
+    qint64 allocations = 0;
+    qint64 bytes = 0;
+
+    static HeapSnapshot take()
+    {
+        HeapSnapshot snapshot;
+#ifdef HAVE_ALLOCATION_COUNTERS
+        snapshot.allocations = allocationCount.load();
+        snapshot.bytes = liveBytes.load();
+#endif
+        return snapshot;
+    }
+};
+
+// Fresh strings per row, the way QtSql hydrates them
+QVector<Contact> makeContacts(int count)
+{
+    static const char *const firstNames[] = {"Alexander", "Maria", "Wei", "Fatima", "John", "Sofia"};
+    static const char *const lastNames[] = {"Smith", "Garcia", "Chen", "Khan", "Müller", "Rossi"};
+    static const char *const cities[] = {"Berlin", "New York", "Shanghai", "Lagos", "São Paulo"};
+    static const char *const countries[] = {"Germany", "United States", "China", "Nigeria", "Brazil"};
+
+    QRandomGenerator rng(42);
+    QVector<Contact> contacts;
+    contacts.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Contact contact;
+        contact.id = i + 1;
+        contact.firstName = QString::fromUtf8(firstNames[rng.bounded(6)]);
+        contact.lastName = QString::fromUtf8(lastNames[rng.bounded(6)]) + QString::number(i);
+        contact.email = QString("user%1@example.com").arg(i);
+        contact.phone = QString("+1 555 %1").arg(rng.bounded(10000000), 7, 10, QChar('0'));
+        int place = rng.bounded(5);
+        contact.city = QString::fromUtf8(cities[place]);
+        contact.country = QString::fromUtf8(countries[place]);
+        contacts.append(contact);
+    }
+    return contacts;
+}
+
+// What the table view does: one QString per visible cell
+qint64 scanVector(const QVector<Contact> &contacts)
+{
+    qint64 characters = 0;
+    for (const Contact &contact : contacts) {
+        characters += QString(contact.firstName).size() + QString(contact.lastName).size()
+                      + QString(contact.email).size() + QString(contact.phone).size()
+                      + QString(contact.city).size() + QString(contact.country).size();
+    }
+    return characters;
+}
+
+qint64 scanStore(const ContactStore &store)
+{
+    qint64 characters = 0;
+    for (int row = 0; row < store.size(); ++row) {
+        const ContactStore::View contact = store.at(row);
+        characters += contact.firstName().toString().size() + contact.lastName().toString().size()
+                      + contact.email().toString().size() + contact.phone().toString().size()
+                      + QString(contact.city()).size() + QString(contact.country()).size();
+    }
+    return characters;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int rowCount = argc > 1 ? QString(argv[1]).toInt() : 100000;
+    out << "rows: " << rowCount << "\n";
+
+    QElapsedTimer timer;
+
+    HeapSnapshot start = HeapSnapshot::take();
+    timer.start();
+    QVector<Contact> contacts = makeContacts(rowCount);
+    const qint64 vectorBuildNs = timer.nsecsElapsed();
+    HeapSnapshot afterVector = HeapSnapshot::take();
+
+    timer.start();
+    ContactStore store(contacts);
+    const qint64 storeBuildNs = timer.nsecsElapsed();
+    HeapSnapshot afterStore = HeapSnapshot::take();
+
+    timer.start();
+    const qint64 vectorChars = scanVector(contacts);
+    const qint64 vectorScanNs = timer.nsecsElapsed();
+
+    timer.start();
+    const qint64 storeChars = scanStore(store);
+    const qint64 storeScanNs = timer.nsecsElapsed();
+
+    if (vectorChars != storeChars) {
+        out << "mismatch: " << vectorChars << " vs " << storeChars << " characters\n";
+        return 1;
+    }
+
+#ifdef HAVE_ALLOCATION_COUNTERS
+    const qint64 vectorBytes = afterVector.bytes - start.bytes;
+    const qint64 vectorAllocs = afterVector.allocations - start.allocations;
+    const qint64 storeBytes = afterStore.bytes - afterVector.bytes;
+    const qint64 storeAllocs = afterStore.allocations - afterVector.allocations;
+
+    out << QString("QVector<Contact>  %1 bytes/row  %2 allocations (%3/row)\n")
+               .arg(double(vectorBytes) / rowCount, 0, 'f', 1)
+               .arg(vectorAllocs).arg(double(vectorAllocs) / rowCount, 0, 'f', 2);
+    out << QString("ContactStore      %1 bytes/row  %2 allocations (%3/row)\n")
+               .arg(double(storeBytes) / rowCount, 0, 'f', 1)
+               .arg(storeAllocs).arg(double(storeAllocs) / rowCount, 0, 'f', 2);
+    out << QString("ContactStore::memoryUsage estimate: %1 bytes/row\n")
+               .arg(double(store.memoryUsage()) / rowCount, 0, 'f', 1);
+    out << QString("saving: %1%\n")
+               .arg(100.0 * (vectorBytes - storeBytes) / qMax<qint64>(1, vectorBytes), 0, 'f', 1);
+#else
+    out << "allocation counters need glibc; timings only\n";
+#endif
+
+    out << QString("build  QVector: %1 ms  ContactStore: %2 ms\n")
+               .arg(vectorBuildNs / 1e6, 0, 'f', 1).arg(storeBuildNs / 1e6, 0, 'f', 1);
+    out << QString("scan   QVector: %1 ms  ContactStore: %2 ms\n")
+               .arg(vectorScanNs / 1e6, 0, 'f', 1).arg(storeScanNs / 1e6, 0, 'f', 1);
+    return 0;
+}
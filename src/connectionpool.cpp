@@ -0,0 +1,133 @@
+#include "connectionpool.h"
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+
+// Per-connection tuning, matching the main connection. The journal mode
+// is persistent and set once by the main connection; synchronous is not,
+// so every pooled writer would otherwise sync each commit (FULL)
+const char *const PooledPragmas[] = {
+    "PRAGMA synchronous = NORMAL",       // with WAL, sync only at checkpoints
+    "PRAGMA cache_size = -16000",        // 16 MiB page cache per connection
+    "PRAGMA mmap_size = 268435456",      // map up to 256 MiB of the file
+    "PRAGMA temp_store = MEMORY"
+};
+
+} // namespace
+
+ConnectionPool::ConnectionPool(Access access, QObject *parent)
+    : QObject(parent), m_access(access), m_generation(0)
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    // Connections of threads that are still running are left to Qt's
+    // global cleanup; closing them from here would cross threads.
+}
+
+void ConnectionPool::setDatabasePath(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_path = path;
+    ++m_generation;
+}
+
+void ConnectionPool::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+}
+
+QSqlDatabase ConnectionPool::connection(QString *error)
+{
+    QThread *thread = QThread::currentThread();
+    QString path;
+    QString name;
+    bool known = false;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        path = m_path;
+        auto it = m_slots.find(thread);
+        if (it != m_slots.end()) {
+            known = true;
+            if (it->generation == m_generation) {
+                name = it->name;
+            } else {
+                // Retired by invalidate(); reopen below
+                closeConnection(it->name);
+            }
+        }
+
+        if (name.isEmpty()) {
+            name = QString("contacts-%1-%2-%3")
+                       .arg(m_access == ReadOnly ? "read" : "write")
+                       .arg(quintptr(thread)).arg(m_generation);
+            m_slots.insert(thread, {name, m_generation});
+        }
+    }
+
+    if (!known) {
+        // Runs on the finishing thread, which owns the connection
+        connect(thread, &QThread::finished, this,
+                [this, thread]() { release(thread); }, Qt::DirectConnection);
+    }
+
+    if (QSqlDatabase::contains(name)) {
+        return QSqlDatabase::database(name);
+    }
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+    database.setDatabaseName(path);
+    database.setConnectOptions(m_access == ReadOnly
+                               ? "QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000"
+                               : "QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!database.open()) {
+        if (error) *error = "Failed to open pooled connection: " + database.lastError().text();
+        return database;
+    }
+
+    QSqlQuery query(database);
+    for (const char *pragma : PooledPragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "ConnectionPool:" << pragma << "failed:" << query.lastError().text();
+        }
+    }
+
+    return database;
+}
+
+int ConnectionPool::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_slots.size();
+}
+
+void ConnectionPool::release(QThread *thread)
+{
+    QString name;
+    {
+        QMutexLocker locker(&m_mutex);
+        name = m_slots.take(thread).name;
+    }
+    if (!name.isEmpty()) {
+        closeConnection(name);
+    }
+}
+
+void ConnectionPool::closeConnection(const QString &name)
+{
+    if (!QSqlDatabase::contains(name)) return;
+
+    {
+        QSqlDatabase database = QSqlDatabase::database(name, false);
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
@@ -0,0 +1,60 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+
+class QThread;
+
+/**
+ * @brief Hands out one SQLite connection per thread
+ *
+ * QSqlDatabase connections may only be used on the thread that opened
+ * them, so each worker thread gets its own named connection, opened
+ * lazily on first use and removed when the thread finishes. With the
+ * database in WAL mode read-only connections never block each other or
+ * the writer, so read throughput scales with the number of threads;
+ * read-write connections queue on the busy timeout instead of failing.
+ *
+ * connection() is thread-safe. invalidate() retires every connection;
+ * each thread reopens on its next call.
+ */
+class ConnectionPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Access {
+        ReadOnly,
+        ReadWrite
+    };
+
+    explicit ConnectionPool(Access access, QObject *parent = nullptr);
+    ~ConnectionPool();
+
+    void setDatabasePath(const QString &path);
+    void invalidate();
+
+    // The calling thread's connection; invalid (check isOpen()) on failure
+    QSqlDatabase connection(QString *error = nullptr);
+    int size() const;
+
+private:
+    struct Slot {
+        QString name;
+        int generation;
+    };
+
+    Access m_access;
+    mutable QMutex m_mutex;
+    QString m_path;
+    int m_generation;
+    QHash<QThread *, Slot> m_slots;
+
+    void release(QThread *thread);
+    static void closeConnection(const QString &name);
+};
+
+#endif // CONNECTIONPOOL_H
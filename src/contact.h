@@ -2,6 +2,7 @@
 #define CONTACT_H
 
 #include <QString>
+#include <optional>
 
 
 struct Contact {
@@ -30,4 +31,31 @@ struct Contact {
     }
 };
 
+/**
+ * @brief Field values to write into many contacts at once
+ *
+ * Unset fields keep each contact's own value.
+ */
+struct ContactPatch {
+    std::optional<QString> firstName;
+    std::optional<QString> lastName;
+    std::optional<QString> email;
+    std::optional<QString> phone;
+    std::optional<QString> city;
+    std::optional<QString> country;
+
+    bool isEmpty() const {
+        return !firstName && !lastName && !email && !phone && !city && !country;
+    }
+
+    void applyTo(Contact *contact) const {
+        if (firstName) contact->firstName = *firstName;
+        if (lastName) contact->lastName = *lastName;
+        if (email) contact->email = *email;
+        if (phone) contact->phone = *phone;
+        if (city) contact->city = *city;
+        if (country) contact->country = *country;
+    }
+};
+
 #endif // CONTACT_H
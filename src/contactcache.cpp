@@ -0,0 +1,105 @@
+#include "contactcache.h"
+
+namespace {
+
+// Rough per-entry bookkeeping: list node, hash node and QString headers
+const qint64 EntryOverhead = 64;
+
+qint64 stringCost(const QString &s)
+{
+    return s.isNull() ? 0 : qint64(s.capacity()) * qint64(sizeof(QChar)) + 16;
+}
+
+} // namespace
+
+ContactCache::ContactCache(qint64 budgetBytes)
+    : m_budget(budgetBytes), m_bytes(0)
+{
+}
+
+void ContactCache::setBudget(qint64 budgetBytes)
+{
+    m_budget = budgetBytes;
+    evictToBudget();
+}
+
+bool ContactCache::lookup(int id, Contact *contact)
+{
+    auto it = m_index.constFind(id);
+    if (it == m_index.constEnd()) {
+        ++m_stats.misses;
+        return false;
+    }
+
+    ++m_stats.hits;
+    m_entries.splice(m_entries.begin(), m_entries, it.value());
+    *contact = it.value()->contact;
+    return true;
+}
+
+void ContactCache::insert(const Contact &contact)
+{
+    if (contact.id <= 0) return;
+
+    remove(contact.id);
+
+    const qint64 cost = costOf(contact);
+    if (cost > m_budget) return;
+
+    m_entries.push_front({contact, cost});
+    m_index.insert(contact.id, m_entries.begin());
+    m_bytes += cost;
+    ++m_stats.insertions;
+
+    evictToBudget();
+}
+
+void ContactCache::remove(int id)
+{
+    auto it = m_index.find(id);
+    if (it == m_index.end()) return;
+
+    m_bytes -= it.value()->cost;
+    m_entries.erase(it.value());
+    m_index.erase(it);
+}
+
+void ContactCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+ContactCacheStats ContactCache::stats() const
+{
+    ContactCacheStats stats = m_stats;
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    stats.entries = m_index.size();
+    return stats;
+}
+
+void ContactCache::resetStats()
+{
+    m_stats = ContactCacheStats();
+}
+
+qint64 ContactCache::costOf(const Contact &contact)
+{
+    return qint64(sizeof(Contact)) + EntryOverhead
+        + stringCost(contact.firstName) + stringCost(contact.lastName)
+        + stringCost(contact.email) + stringCost(contact.phone)
+        + stringCost(contact.city) + stringCost(contact.country);
+}
+
+void ContactCache::evictToBudget()
+{
+    while (m_bytes > m_budget && !m_entries.empty()) {
+        const Entry &victim = m_entries.back();
+        m_bytes -= victim.cost;
+        m_index.remove(victim.contact.id);
+        m_entries.pop_back();
+        ++m_stats.evictions;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef CONTACTCACHE_H
+#define CONTACTCACHE_H
+
+#include <QHash>
+#include <list>
+#include "contact.h"
+
+/**
+ * @brief Hit/miss counters for tuning the cache budget
+ */
+struct ContactCacheStats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+    quint64 insertions = 0;
+    qint64 bytes = 0;
+    qint64 budget = 0;
+    int entries = 0;
+
+    double hitRate() const {
+        quint64 lookups = hits + misses;
+        return lookups ? double(hits) / lookups : 0.0;
+    }
+};
+
+/**
+ * @brief Least-recently-used id -> Contact cache bounded by a byte budget
+ *
+ * The cost of an entry is an estimate of its heap footprint (struct plus
+ * string payloads), so the budget holds regardless of field lengths.
+ * Not thread-safe; owned and used by DatabaseManager on its thread.
+ */
+class ContactCache
+{
+public:
+    static constexpr qint64 DefaultBudget = 8 * 1024 * 1024;
+
+    explicit ContactCache(qint64 budgetBytes = DefaultBudget);
+
+    void setBudget(qint64 budgetBytes);
+    qint64 budget() const { return m_budget; }
+
+    // Counts a hit or a miss; a hit also marks the entry most recently used
+    bool lookup(int id, Contact *contact);
+    void insert(const Contact &contact);
+    void remove(int id);
+    void clear();
+
+    ContactCacheStats stats() const;
+    void resetStats();
+
+    static qint64 costOf(const Contact &contact);
+
+private:
+    struct Entry {
+        Contact contact;
+        qint64 cost;
+    };
+    using EntryList = std::list<Entry>;
+
+    EntryList m_entries;        // front = most recently used
+    QHash<int, EntryList::iterator> m_index;
+    qint64 m_budget;
+    qint64 m_bytes;
+    ContactCacheStats m_stats;
+
+    void evictToBudget();
+};
+
+#endif // CONTACTCACHE_H
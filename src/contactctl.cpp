@@ -0,0 +1,283 @@
+// Headless front end to DatabaseManager for scripts and servers.
+//
+// Usage: contactctl [options] <command> [arguments]
+//
+//   import <file>      CSV or vCard into the book
+//   export <file>      the whole book as CSV, vCard or NDJSON (by extension)
+//   search <terms>     matching contacts as tab-separated rows
+//   dedup              likely duplicate pairs; --merge merges them
+//   vacuum             reclaim space left by deleted rows
+//   count              number of contacts
+//
+// With --bench each command also reports how long it took and its
+// throughput on stderr, so stdout stays parseable.
+
+#include "contactexporter.h"
+#include "contactimporter.h"
+#include "databasemanager.h"
+#include "duplicatefinder.h"
+#include "memorystorageengine.h"
+#include "sqlitestorageengine.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QTextStream>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+/**
+ * Times one operation and, in bench mode, prints its throughput.
+ */
+class OperationTimer
+{
+public:
+    OperationTimer(const QString &name, bool enabled) : m_name(name), m_enabled(enabled)
+    {
+        m_timer.start();
+    }
+
+    void report(qint64 items, const QString &unit)
+    {
+        if (!m_enabled) return;
+
+        const qint64 ns = qMax<qint64>(1, m_timer.nsecsElapsed());
+        err() << QString("%1: %2 %3 in %4 ms (%5 %3/s)")
+                     .arg(m_name).arg(items).arg(unit)
+                     .arg(ns / 1e6, 0, 'f', 1)
+                     .arg(items * 1e9 / ns, 0, 'f', 0)
+              << Qt::endl;
+    }
+
+private:
+    QString m_name;
+    bool m_enabled;
+    QElapsedTimer m_timer;
+};
+
+QString row(const Contact &contact)
+{
+    return QStringList{QString::number(contact.id), contact.firstName, contact.lastName,
+                       contact.email, contact.phone, contact.city, contact.country}
+        .join('\t');
+}
+
+int runImport(DatabaseManager &db, const QString &filePath, bool bench)
+{
+    if (!ContactImporter::isSupportedFile(filePath)) {
+        err() << "Unsupported file format: " << filePath << Qt::endl;
+        return 1;
+    }
+
+    std::atomic<bool> cancelled(false);
+    ContactImportWorker worker(&db, &cancelled);
+    ImportSummary result;
+    QObject::connect(&worker, &ContactImportWorker::finished,
+                     [&result](const ImportSummary &summary) { result = summary; });
+
+    OperationTimer timer("import", bench);
+    worker.importFile(filePath);
+    timer.report(result.imported, "rows");
+
+    if (!result.succeeded()) {
+        err() << "Import failed: " << result.error << Qt::endl;
+        return 1;
+    }
+    out() << "Imported " << result.imported << " contacts, skipped " << result.skipped << Qt::endl;
+    return 0;
+}
+
+int runExport(DatabaseManager &db, const QString &filePath, bool bench)
+{
+    if (!ContactExporter::isSupportedFile(filePath)) {
+        err() << "Unsupported file format: " << filePath << Qt::endl;
+        return 1;
+    }
+
+    std::atomic<bool> cancelled(false);
+    ContactExportWorker worker(&db, &cancelled);
+    ExportSummary result;
+    QObject::connect(&worker, &ContactExportWorker::finished,
+                     [&result](const ExportSummary &summary) { result = summary; });
+
+    OperationTimer timer("export", bench);
+    worker.exportFile(filePath);
+    timer.report(result.exported, "rows");
+
+    if (!result.succeeded()) {
+        err() << "Export failed: " << result.error << Qt::endl;
+        return 1;
+    }
+    out() << "Exported " << result.exported << " contacts" << Qt::endl;
+    return 0;
+}
+
+int runSearch(DatabaseManager &db, const QString &term, int limit, int repeat, bool bench)
+{
+    QVector<Contact> contacts;
+    OperationTimer timer("search", bench);
+    for (int i = 0; i < repeat; ++i) {
+        contacts = db.searchContacts(term, limit);
+    }
+    timer.report(repeat, "queries");
+
+    for (const Contact &contact : contacts) {
+        out() << row(contact) << '\n';
+    }
+    out().flush();
+    return 0;
+}
+
+int runDedup(DatabaseManager &db, double threshold, bool merge, bool bench)
+{
+    OperationTimer loadTimer("load", bench);
+    const QVector<Contact> contacts = db.getAllContacts();
+    loadTimer.report(contacts.size(), "rows");
+
+    DuplicateOptions options;
+    options.threshold = threshold;
+
+    OperationTimer scanTimer("dedup", bench);
+    const QVector<DuplicateMatch> matches = DuplicateFinder::find(contacts, options);
+    scanTimer.report(contacts.size(), "rows");
+
+    for (const DuplicateMatch &match : matches) {
+        out() << QString::number(match.score, 'f', 2) << '\t' << match.first.id << '\t'
+              << match.second.id << '\t' << match.reasons.join(", ") << '\n';
+    }
+    out().flush();
+
+    if (!merge) return 0;
+
+    // Each contact takes part in at most one merge per run; chains of
+    // duplicates collapse over repeated runs
+    QSet<int> touched;
+    int merged = 0;
+    OperationTimer mergeTimer("merge", bench);
+    for (const DuplicateMatch &match : matches) {
+        if (touched.contains(match.first.id) || touched.contains(match.second.id)) continue;
+        touched.insert(match.first.id);
+        touched.insert(match.second.id);
+
+        if (!db.mergeContacts(DuplicateFinder::merged(match.first, match.second), {match.second.id})) {
+            err() << "Merge of " << match.second.id << " into " << match.first.id
+                  << " failed: " << db.lastError() << Qt::endl;
+            return 1;
+        }
+        ++merged;
+    }
+    mergeTimer.report(merged, "merges");
+
+    err() << "Merged " << merged << " of " << matches.size() << " pairs" << Qt::endl;
+    return 0;
+}
+
+int runVacuum(DatabaseManager &db, bool bench)
+{
+    OperationTimer timer("vacuum", bench);
+    if (!db.compactStorage()) {
+        err() << "Vacuum failed: " << db.lastError() << Qt::endl;
+        return 1;
+    }
+    timer.report(1, "runs");
+    return 0;
+}
+
+int runCount(DatabaseManager &db, bool bench)
+{
+    QString error;
+    OperationTimer timer("count", bench);
+    const int count = db.storageEngine()->count(&error);
+    timer.report(1, "queries");
+
+    if (count < 0) {
+        err() << "Count failed: " << error << Qt::endl;
+        return 1;
+    }
+    out() << count << Qt::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("contactctl");
+    app.setApplicationVersion("1.0.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Batch operations on a contact book.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption databaseOption({"d", "database"}, "SQLite database file.", "path", "contacts.db");
+    QCommandLineOption memoryOption("memory", "Use the in-memory engine backed by this log file.", "log");
+    QCommandLineOption benchOption("bench", "Report time and throughput of each operation on stderr.");
+    QCommandLineOption limitOption("limit", "Maximum search results (default: all).", "n", "-1");
+    QCommandLineOption repeatOption("repeat", "Run the search this many times (for --bench).", "n", "1");
+    QCommandLineOption thresholdOption("threshold", "Minimum duplicate score.", "score", "0.6");
+    QCommandLineOption mergeOption("merge", "Merge each duplicate pair into its older contact.");
+    parser.addOptions({databaseOption, memoryOption, benchOption, limitOption, repeatOption,
+                       thresholdOption, mergeOption});
+    parser.addPositionalArgument("command", "import, export, search, dedup, vacuum or count.");
+    parser.addPositionalArgument("arguments", "File for import/export, terms for search.", "[arguments...]");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.isEmpty()) {
+        parser.showHelp(1);
+    }
+    const QString command = arguments.first();
+    const bool bench = parser.isSet(benchOption);
+
+    DatabaseManager db;
+    if (parser.isSet(memoryOption)) {
+        db.setStorageEngine(std::make_unique<MemoryStorageEngine>(parser.value(memoryOption)));
+    } else {
+        db.setStorageEngine(std::make_unique<SqliteStorageEngine>(parser.value(databaseOption)));
+    }
+
+    OperationTimer openTimer("open", bench);
+    if (!db.connectToDatabase(QString(), QString(), QString(), QString()) || !db.createTable()) {
+        err() << "Cannot open contacts: " << db.lastError() << Qt::endl;
+        return 1;
+    }
+    openTimer.report(1, "opens");
+
+    int status = 0;
+    if (command == "import" && arguments.size() == 2) {
+        status = runImport(db, arguments.at(1), bench);
+    } else if (command == "export" && arguments.size() == 2) {
+        status = runExport(db, arguments.at(1), bench);
+    } else if (command == "search" && arguments.size() >= 2) {
+        status = runSearch(db, arguments.mid(1).join(' '), parser.value(limitOption).toInt(),
+                           qMax(1, parser.value(repeatOption).toInt()), bench);
+    } else if (command == "dedup" && arguments.size() == 1) {
+        status = runDedup(db, parser.value(thresholdOption).toDouble(), parser.isSet(mergeOption), bench);
+    } else if (command == "vacuum" && arguments.size() == 1) {
+        status = runVacuum(db, bench);
+    } else if (command == "count" && arguments.size() == 1) {
+        status = runCount(db, bench);
+    } else {
+        err() << "Unknown command or wrong arguments: " << arguments.join(' ') << Qt::endl;
+        status = 2;
+    }
+
+    db.disconnectFromDatabase();
+    return status;
+}
@@ -0,0 +1,274 @@
+#include "contactexporter.h"
+#include "databasemanager.h"
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QDebug>
+#include <memory>
+
+namespace {
+
+/**
+ * Push-style record writer; the caller owns the stream and its buffering.
+ */
+class ContactWriter
+{
+public:
+    virtual ~ContactWriter() = default;
+    virtual void begin() {}
+    virtual void write(const Contact &contact) = 0;
+};
+
+// ============= CSV =============
+
+class CsvContactWriter : public ContactWriter
+{
+public:
+    explicit CsvContactWriter(QTextStream *stream) : m_stream(stream) {}
+
+    void begin() override
+    {
+        // Header names the importer maps back to the same columns
+        *m_stream << "first_name,last_name,email,phone,city,country\r\n";
+    }
+
+    void write(const Contact &contact) override
+    {
+        *m_stream << quoted(contact.firstName) << ',' << quoted(contact.lastName) << ','
+                  << quoted(contact.email) << ',' << quoted(contact.phone) << ','
+                  << quoted(contact.city) << ',' << quoted(contact.country) << "\r\n";
+    }
+
+private:
+    QTextStream *m_stream;
+
+    // RFC 4180: quote fields holding a delimiter, quote or line break
+    static QString quoted(const QString &value)
+    {
+        if (!value.contains(',') && !value.contains('"') && !value.contains(';')
+            && !value.contains('\n') && !value.contains('\r')) {
+            return value;
+        }
+        QString result = value;
+        result.replace('"', "\"\"");
+        return '"' + result + '"';
+    }
+};
+
+// ============= vCard =============
+
+class VCardContactWriter : public ContactWriter
+{
+public:
+    explicit VCardContactWriter(QTextStream *stream) : m_stream(stream) {}
+
+    void write(const Contact &contact) override
+    {
+        *m_stream << "BEGIN:VCARD\r\n"
+                  << "VERSION:3.0\r\n"
+                  << "N:" << escaped(contact.lastName) << ';' << escaped(contact.firstName) << ";;;\r\n"
+                  << "FN:" << escaped(contact.fullName()) << "\r\n";
+        if (!contact.email.isEmpty()) {
+            *m_stream << "EMAIL;TYPE=INTERNET:" << escaped(contact.email) << "\r\n";
+        }
+        if (!contact.phone.isEmpty()) {
+            *m_stream << "TEL:" << escaped(contact.phone) << "\r\n";
+        }
+        if (!contact.city.isEmpty() || !contact.country.isEmpty()) {
+            // PO box; extended; street; locality; region; postal code; country
+            *m_stream << "ADR:;;;" << escaped(contact.city) << ";;;" << escaped(contact.country) << "\r\n";
+        }
+        *m_stream << "END:VCARD\r\n";
+    }
+
+private:
+    QTextStream *m_stream;
+
+    static QString escaped(const QString &value)
+    {
+        QString result;
+        result.reserve(value.size());
+        for (const QChar c : value) {
+            if (c == '\\' || c == ';' || c == ',') {
+                result += '\\';
+                result += c;
+            } else if (c == '\n') {
+                result += "\\n";
+            } else if (c != '\r') {
+                result += c;
+            }
+        }
+        return result;
+    }
+};
+
+// ============= NDJSON =============
+
+class JsonLinesContactWriter : public ContactWriter
+{
+public:
+    explicit JsonLinesContactWriter(QTextStream *stream) : m_stream(stream) {}
+
+    void write(const Contact &contact) override
+    {
+        QJsonObject object;
+        object["id"] = contact.id;
+        object["first_name"] = contact.firstName;
+        object["last_name"] = contact.lastName;
+        object["email"] = contact.email;
+        object["phone"] = contact.phone;
+        object["city"] = contact.city;
+        object["country"] = contact.country;
+        *m_stream << QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact)) << '\n';
+    }
+
+private:
+    QTextStream *m_stream;
+};
+
+std::unique_ptr<ContactWriter> createWriter(const QString &filePath, QTextStream *stream)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "csv") {
+        return std::make_unique<CsvContactWriter>(stream);
+    }
+    if (suffix == "vcf" || suffix == "vcard") {
+        return std::make_unique<VCardContactWriter>(stream);
+    }
+    if (suffix == "ndjson" || suffix == "jsonl") {
+        return std::make_unique<JsonLinesContactWriter>(stream);
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// ============= ContactExportWorker =============
+
+ContactExportWorker::ContactExportWorker(DatabaseManager *dbManager,
+                                         const std::atomic<bool> *cancelled)
+    : m_dbManager(dbManager)
+    , m_cancelled(cancelled)
+{
+}
+
+void ContactExportWorker::exportFile(const QString &filePath)
+{
+    ExportSummary summary;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        summary.error = "Cannot open " + filePath + ": " + file.errorString();
+        emit finished(summary);
+        return;
+    }
+
+    QTextStream stream(&file);
+    std::unique_ptr<ContactWriter> writer = createWriter(filePath, &stream);
+    if (!writer) {
+        file.cancelWriting();
+        summary.error = "Unsupported file format: " + filePath;
+        emit finished(summary);
+        return;
+    }
+
+    StorageEngine *engine = m_dbManager->storageEngine();
+
+    // Only used for progress; rows added meanwhile just overshoot it
+    const int total = engine->count();
+    emit progress(0, qMax(0, total));
+
+    writer->begin();
+    bool ok = engine->forEach([&](const Contact &contact) {
+        writer->write(contact);
+        ++summary.exported;
+
+        if (summary.exported % ProgressInterval == 0) {
+            if (stream.status() != QTextStream::Ok) return false;
+            if (m_cancelled->load(std::memory_order_relaxed)) {
+                summary.cancelled = true;
+                return false;
+            }
+            emit progress(summary.exported, qMax(total, summary.exported));
+        }
+        return true;
+    }, &summary.error);
+
+    stream.flush();
+    if (ok && stream.status() != QTextStream::Ok) {
+        ok = false;
+        summary.error = "Failed to write " + filePath + ": " + file.errorString();
+    }
+
+    if (!ok || summary.cancelled) {
+        file.cancelWriting();
+    } else if (!file.commit()) {
+        summary.error = "Failed to save " + filePath + ": " + file.errorString();
+    }
+
+    qDebug() << "Export finished:" << summary.exported << "exported"
+             << (summary.cancelled ? "(cancelled)" : "");
+    emit finished(summary);
+}
+
+// ============= ContactExporter =============
+
+ContactExporter::ContactExporter(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(dbManager)
+    , m_running(false)
+    , m_cancelled(false)
+{
+    qRegisterMetaType<ExportSummary>("ExportSummary");
+
+    auto *worker = new ContactExportWorker(m_dbManager, &m_cancelled);
+    worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &ContactExporter::workerExportRequested,
+            worker, &ContactExportWorker::exportFile);
+    connect(worker, &ContactExportWorker::progress,
+            this, &ContactExporter::progress);
+    connect(worker, &ContactExportWorker::finished,
+            this, &ContactExporter::onWorkerFinished);
+
+    m_thread.setObjectName("ContactExporter");
+    m_thread.start();
+}
+
+ContactExporter::~ContactExporter()
+{
+    cancel();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool ContactExporter::isSupportedFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    return suffix == "csv" || suffix == "vcf" || suffix == "vcard"
+           || suffix == "ndjson" || suffix == "jsonl";
+}
+
+bool ContactExporter::start(const QString &filePath)
+{
+    if (m_running || !m_dbManager->isConnected()) return false;
+
+    m_running = true;
+    m_cancelled = false;
+    emit started(filePath);
+    emit workerExportRequested(filePath);
+    return true;
+}
+
+void ContactExporter::cancel()
+{
+    m_cancelled = true;
+}
+
+void ContactExporter::onWorkerFinished(const ExportSummary &summary)
+{
+    m_running = false;
+    emit finished(summary);
+}
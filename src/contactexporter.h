@@ -0,0 +1,92 @@
+#ifndef CONTACTEXPORTER_H
+#define CONTACTEXPORTER_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+
+class DatabaseManager;
+
+/**
+ * @brief Result of a finished (or cancelled) export
+ */
+struct ExportSummary {
+    int exported = 0;
+    bool cancelled = false;
+    QString error;
+
+    bool succeeded() const { return error.isEmpty(); }
+};
+
+/**
+ * @brief Streams every contact from the database into a file
+ *
+ * Lives on the exporter's worker thread and walks the storage engine
+ * with forEach(), so only the current row is held in memory whatever
+ * the size of the table. Output goes through a QSaveFile: a failed or
+ * cancelled export leaves any existing file untouched.
+ */
+class ContactExportWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Rows between progress updates and cancellation checks
+    static constexpr int ProgressInterval = 5000;
+
+    ContactExportWorker(DatabaseManager *dbManager, const std::atomic<bool> *cancelled);
+
+public slots:
+    void exportFile(const QString &filePath);
+
+signals:
+    void progress(int exported, int total);
+    void finished(const ExportSummary &summary);
+
+private:
+    DatabaseManager *m_dbManager;
+    const std::atomic<bool> *m_cancelled;
+};
+
+/**
+ * @brief Exports contacts to CSV, vCard 3.0 or NDJSON in the background
+ *
+ * The format is picked from the file extension (.csv, .vcf, .vcard,
+ * .ndjson, .jsonl). CSV and vCard output can be read back by
+ * ContactImporter. Only one export runs at a time and finished() is
+ * emitted exactly once per export.
+ */
+class ContactExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ContactExporter(DatabaseManager *dbManager, QObject *parent = nullptr);
+    ~ContactExporter();
+
+    bool isRunning() const { return m_running; }
+    static bool isSupportedFile(const QString &filePath);
+
+public slots:
+    bool start(const QString &filePath);
+    void cancel();
+
+signals:
+    void started(const QString &filePath);
+    void progress(int exported, int total);
+    void finished(const ExportSummary &summary);
+
+    // Internal: hands the file over to the worker thread
+    void workerExportRequested(const QString &filePath);
+
+private slots:
+    void onWorkerFinished(const ExportSummary &summary);
+
+private:
+    DatabaseManager *m_dbManager;
+    QThread m_thread;
+    bool m_running;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // CONTACTEXPORTER_H
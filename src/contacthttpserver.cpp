@@ -0,0 +1,497 @@
+#include "contacthttpserver.h"
+#include "databasemanager.h"
+#include "logging.h"
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPromise>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <memory>
+
+namespace {
+
+QFuture<HttpResponse> ready(const HttpResponse &response)
+{
+    QPromise<HttpResponse> promise;
+    promise.start();
+    promise.addResult(response);
+    promise.finish();
+    return promise.future();
+}
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 411: return "Length Required";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Unknown";
+    }
+}
+
+QJsonObject toJson(const Contact &contact)
+{
+    QJsonObject object;
+    object["id"] = contact.id;
+    object["first_name"] = contact.firstName;
+    object["last_name"] = contact.lastName;
+    object["email"] = contact.email;
+    object["phone"] = contact.phone;
+    object["city"] = contact.city;
+    object["country"] = contact.country;
+    return object;
+}
+
+QJsonArray toJson(const QVector<Contact> &contacts)
+{
+    QJsonArray array;
+    for (const Contact &contact : contacts) {
+        array.append(toJson(contact));
+    }
+    return array;
+}
+
+bool fromJson(const QByteArray &body, Contact *contact)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(body, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) return false;
+
+    const QJsonObject object = document.object();
+    contact->firstName = object.value("first_name").toString();
+    contact->lastName = object.value("last_name").toString();
+    contact->email = object.value("email").toString();
+    contact->phone = object.value("phone").toString();
+    contact->city = object.value("city").toString();
+    contact->country = object.value("country").toString();
+    return true;
+}
+
+// Opaque keyset cursor: the sort key of the last row served
+QString encodeCursor(const Contact &contact)
+{
+    const QJsonArray key{contact.firstName, contact.lastName, contact.id};
+    return QString::fromLatin1(QJsonDocument(key).toJson(QJsonDocument::Compact)
+                                   .toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+bool decodeCursor(const QString &cursor, Contact *after)
+{
+    const QByteArray json = QByteArray::fromBase64(cursor.toLatin1(), QByteArray::Base64UrlEncoding);
+    const QJsonArray key = QJsonDocument::fromJson(json).array();
+    if (key.size() != 3 || !key.at(2).isDouble()) return false;
+
+    after->firstName = key.at(0).toString();
+    after->lastName = key.at(1).toString();
+    after->id = key.at(2).toInt();
+    return true;
+}
+
+int pageSize(const HttpRequest &request)
+{
+    bool ok = false;
+    const int limit = request.query.queryItemValue("limit").toInt(&ok);
+    return ok ? qBound(1, limit, ContactHttpServer::MaxPageSize) : ContactHttpServer::DefaultPageSize;
+}
+
+HttpResponse writeResponse(ContactWrite::Kind kind, const WriteResult &result)
+{
+    if (!result.succeeded()) {
+        if (result.error == "Contact not found") return HttpResponse::error(404, result.error);
+        if (result.error.startsWith("Invalid")) return HttpResponse::error(400, result.error);
+        if (result.error == "Database not connected") return HttpResponse::error(503, result.error);
+        return HttpResponse::error(500, result.error);
+    }
+
+    switch (kind) {
+    case ContactWrite::Insert:
+        return HttpResponse::json(201, QJsonDocument(toJson(result.contact)));
+    case ContactWrite::Update:
+        return HttpResponse::json(200, QJsonDocument(toJson(result.contact)));
+    case ContactWrite::Remove:
+        break;
+    }
+    HttpResponse response;
+    response.status = 204;
+    return response;
+}
+
+} // namespace
+
+// ============= HttpResponse =============
+
+HttpResponse HttpResponse::json(int status, const QJsonDocument &document)
+{
+    HttpResponse response;
+    response.status = status;
+    response.body = document.toJson(QJsonDocument::Compact);
+    return response;
+}
+
+HttpResponse HttpResponse::error(int status, const QString &message)
+{
+    return json(status, QJsonDocument(QJsonObject{{"error", message}}));
+}
+
+// ============= HttpConnection =============
+
+HttpConnection::HttpConnection(qintptr socketDescriptor, ContactHttpServer *server, QObject *parent)
+    : QObject(parent)
+    , m_server(server)
+    , m_socket(new QTcpSocket(this))
+    , m_idleTimer(new QTimer(this))
+    , m_valid(false)
+    , m_busy(false)
+{
+    if (!m_socket->setSocketDescriptor(socketDescriptor)) {
+        qCWarning(lcNetwork) << "HTTP: cannot adopt socket:" << m_socket->errorString();
+        return;
+    }
+    m_valid = true;
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(IdleTimeoutMs);
+    connect(m_idleTimer, &QTimer::timeout, m_socket, &QTcpSocket::disconnectFromHost);
+    connect(m_socket, &QTcpSocket::readyRead, this, &HttpConnection::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &QObject::deleteLater);
+    m_idleTimer->start();
+}
+
+void HttpConnection::onReadyRead()
+{
+    m_buffer.append(m_socket->readAll());
+    m_idleTimer->start();
+
+    // A client that keeps sending while we are busy gets cut off at one
+    // maximal request's worth of backlog
+    if (m_buffer.size() > MaxHeaderBytes + MaxBodyBytes) {
+        m_socket->abort();
+        return;
+    }
+    processBuffer();
+}
+
+void HttpConnection::processBuffer()
+{
+    if (m_busy) return;
+
+    HttpRequest request;
+    int status = 400;
+    switch (parseRequest(&request, &status)) {
+    case NeedMore:
+        return;
+    case Invalid:
+        m_buffer.clear();
+        send(HttpResponse::error(status, QString::fromLatin1(reasonPhrase(status))), false);
+        return;
+    case Parsed:
+        break;
+    }
+
+    m_busy = true;
+    const bool keepAlive = request.keepAlive;
+    m_server->handle(request)
+        .then(this, [this, keepAlive](const HttpResponse &response) {
+            m_busy = false;
+            send(response, keepAlive);
+            if (keepAlive) processBuffer();
+        })
+        .onCanceled(this, [this]() {
+            m_busy = false;
+            send(HttpResponse::error(503, "Request dropped"), false);
+        });
+}
+
+HttpConnection::ParseResult HttpConnection::parseRequest(HttpRequest *request, int *status)
+{
+    const int headerEnd = m_buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0 || headerEnd > MaxHeaderBytes) {
+        if (headerEnd > MaxHeaderBytes || m_buffer.size() > MaxHeaderBytes) {
+            *status = 431;
+            return Invalid;
+        }
+        return NeedMore;
+    }
+
+    const QList<QByteArray> lines = m_buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3) return Invalid;
+
+    const QByteArray version = requestLine.at(2);
+    if (!version.startsWith("HTTP/1.")) {
+        *status = 505;
+        return Invalid;
+    }
+
+    QHash<QByteArray, QByteArray> headers;
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray &line = lines.at(i);
+        const int colon = line.indexOf(':');
+        if (colon <= 0) return Invalid;
+        headers.insert(line.left(colon).trimmed().toLower(), line.mid(colon + 1).trimmed());
+    }
+
+    if (headers.contains("transfer-encoding")) {
+        *status = 411;
+        return Invalid;
+    }
+    bool ok = true;
+    const qint64 contentLength = headers.value("content-length", "0").toLongLong(&ok);
+    if (!ok || contentLength < 0) return Invalid;
+    if (contentLength > MaxBodyBytes) {
+        *status = 413;
+        return Invalid;
+    }
+
+    const qint64 requestSize = headerEnd + 4 + contentLength;
+    if (m_buffer.size() < requestSize) return NeedMore;
+
+    const QUrl target = QUrl::fromEncoded(requestLine.at(1));
+    request->method = requestLine.at(0);
+    request->path = target.path();
+    request->query = QUrlQuery(target);
+    request->body = m_buffer.mid(headerEnd + 4, int(contentLength));
+
+    const QByteArray connection = headers.value("connection").toLower();
+    request->keepAlive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+    request->headers = std::move(headers);
+
+    m_buffer.remove(0, int(requestSize));
+    return Parsed;
+}
+
+void HttpConnection::send(const HttpResponse &response, bool keepAlive)
+{
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(response.status) + ' '
+                      + reasonPhrase(response.status) + "\r\n";
+    if (!response.body.isEmpty()) {
+        head += "Content-Type: application/json\r\n";
+    }
+    head += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+    head += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    m_socket->write(head);
+    m_socket->write(response.body);
+    if (!keepAlive) {
+        m_socket->disconnectFromHost();
+    }
+    m_idleTimer->start();
+}
+
+// ============= HttpWorker =============
+
+void HttpWorker::addConnection(qintptr socketDescriptor)
+{
+    auto *connection = new HttpConnection(socketDescriptor, m_server, this);
+    if (!connection->isValid()) {
+        delete connection;
+    }
+}
+
+// ============= ContactHttpServer =============
+
+ContactHttpServer::ContactHttpServer(DatabaseManager *dbManager, QObject *parent)
+    : QTcpServer(parent)
+    , m_dbManager(dbManager)
+    , m_nextWorker(0)
+{
+}
+
+ContactHttpServer::~ContactHttpServer()
+{
+    stop();
+}
+
+bool ContactHttpServer::start(quint16 port, const QHostAddress &address, int workers)
+{
+    if (isListening()) return true;
+
+    if (workers <= 0) {
+        workers = qBound(2, QThread::idealThreadCount(), 8);
+    }
+    for (int i = 0; i < workers; ++i) {
+        auto *thread = new QThread(this);
+        thread->setObjectName(QString("HttpWorker-%1").arg(i));
+        auto *worker = new HttpWorker(this);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+        m_threads.append(thread);
+        m_workers.append(worker);
+    }
+
+    if (!listen(address, port)) {
+        qCWarning(lcNetwork) << "HTTP server cannot listen on" << address.toString() << port
+                             << ":" << errorString();
+        stop();
+        return false;
+    }
+
+    qCInfo(lcNetwork) << "HTTP server listening on" << serverAddress().toString() << serverPort()
+                      << "with" << workers << "workers";
+    return true;
+}
+
+void ContactHttpServer::stop()
+{
+    close();
+    for (QThread *thread : std::as_const(m_threads)) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+    m_threads.clear();
+    m_workers.clear();
+}
+
+void ContactHttpServer::incomingConnection(qintptr socketDescriptor)
+{
+    HttpWorker *worker = m_workers.at(m_nextWorker);
+    m_nextWorker = (m_nextWorker + 1) % m_workers.size();
+
+    // The socket has to be created on the thread that will use it
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor]() {
+        worker->addConnection(socketDescriptor);
+    }, Qt::QueuedConnection);
+}
+
+// ============= Routing =============
+
+QFuture<HttpResponse> ContactHttpServer::handle(const HttpRequest &request)
+{
+    StorageEngine *engine = m_dbManager->storageEngine();
+    if (!engine || !engine->isOpen()) {
+        return ready(HttpResponse::error(503, "Database not connected"));
+    }
+
+    const QStringList segments = request.path.split('/', Qt::SkipEmptyParts);
+    if (segments.isEmpty() || segments.first() != "contacts" || segments.size() > 2) {
+        return ready(HttpResponse::error(404, "No such resource"));
+    }
+
+    if (segments.size() == 1) {
+        if (request.method == "GET") return ready(listContacts(request));
+        if (request.method == "POST") {
+            Contact contact;
+            if (!fromJson(request.body, &contact)) {
+                return ready(HttpResponse::error(400, "Body must be a JSON contact"));
+            }
+            return writeContact(ContactWrite::Insert, contact);
+        }
+        return ready(HttpResponse::error(405, "Use GET or POST"));
+    }
+
+    if (segments.at(1) == "search") {
+        if (request.method != "GET") return ready(HttpResponse::error(405, "Use GET"));
+        return ready(searchContacts(request));
+    }
+
+    bool ok = false;
+    const int id = segments.at(1).toInt(&ok);
+    if (!ok || id <= 0) {
+        return ready(HttpResponse::error(404, "No such contact"));
+    }
+
+    if (request.method == "GET") return ready(getContact(id));
+    if (request.method == "PUT") {
+        Contact contact;
+        if (!fromJson(request.body, &contact)) {
+            return ready(HttpResponse::error(400, "Body must be a JSON contact"));
+        }
+        contact.id = id;
+        return writeContact(ContactWrite::Update, contact);
+    }
+    if (request.method == "DELETE") {
+        Contact contact;
+        contact.id = id;
+        return writeContact(ContactWrite::Remove, contact);
+    }
+    return ready(HttpResponse::error(405, "Use GET, PUT or DELETE"));
+}
+
+HttpResponse ContactHttpServer::listContacts(const HttpRequest &request)
+{
+    Contact after;
+    const QString cursor = request.query.queryItemValue("after");
+    if (!cursor.isEmpty() && !decodeCursor(cursor, &after)) {
+        return HttpResponse::error(400, "Bad cursor");
+    }
+
+    const int limit = pageSize(request);
+    QVector<Contact> contacts;
+    QString error;
+    ScopedLatency latency(m_dbManager->histogram(DatabaseManager::GetContactsPageOp));
+    if (!m_dbManager->storageEngine()->page(after, limit, &contacts, &error)) {
+        latency.setFailed();
+        return HttpResponse::error(500, error);
+    }
+
+    QJsonObject result;
+    result["contacts"] = toJson(contacts);
+    // A short page is the last one
+    result["next"] = contacts.size() == limit ? QJsonValue(encodeCursor(contacts.last())) : QJsonValue();
+    return HttpResponse::json(200, QJsonDocument(result));
+}
+
+HttpResponse ContactHttpServer::searchContacts(const HttpRequest &request)
+{
+    const QString term = request.query.queryItemValue("q", QUrl::FullyDecoded).trimmed();
+    if (term.isEmpty()) {
+        return HttpResponse::error(400, "Missing q");
+    }
+
+    QVector<Contact> contacts;
+    QString error;
+    ScopedLatency latency(m_dbManager->histogram(DatabaseManager::SearchContactsOp));
+    if (!m_dbManager->storageEngine()->search(term, pageSize(request), &contacts, &error)) {
+        latency.setFailed();
+        return HttpResponse::error(500, error);
+    }
+    return HttpResponse::json(200, QJsonDocument(QJsonObject{{"contacts", toJson(contacts)}}));
+}
+
+HttpResponse ContactHttpServer::getContact(int id)
+{
+    Contact contact;
+    QString error;
+    ScopedLatency latency(m_dbManager->histogram(DatabaseManager::GetContactOp));
+    if (!m_dbManager->storageEngine()->get(id, &contact, &error)) {
+        latency.setFailed();
+        return error.isEmpty() ? HttpResponse::error(404, "Contact not found")
+                               : HttpResponse::error(500, error);
+    }
+    return HttpResponse::json(200, QJsonDocument(toJson(contact)));
+}
+
+QFuture<HttpResponse> ContactHttpServer::writeContact(ContactWrite::Kind kind, const Contact &contact)
+{
+    auto committed = std::make_shared<QPromise<WriteResult>>();
+    committed->start();
+    QFuture<WriteResult> future = committed->future();
+
+    // DatabaseManager belongs to the GUI thread; only the enqueue runs there
+    DatabaseManager *dbManager = m_dbManager;
+    QMetaObject::invokeMethod(dbManager, [dbManager, kind, contact, committed]() {
+        QFuture<WriteResult> write = kind == ContactWrite::Insert ? dbManager->addContactAsync(contact)
+                                     : kind == ContactWrite::Update ? dbManager->updateContactAsync(contact)
+                                                                    : dbManager->deleteContactAsync(contact.id);
+        write.then([committed](const WriteResult &result) {
+            committed->addResult(result);
+            committed->finish();
+        });
+    }, Qt::QueuedConnection);
+
+    return future.then([kind](const WriteResult &result) { return writeResponse(kind, result); });
+}
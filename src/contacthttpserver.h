@@ -0,0 +1,152 @@
+#ifndef CONTACTHTTPSERVER_H
+#define CONTACTHTTPSERVER_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QTcpServer>
+#include <QThread>
+#include <QUrlQuery>
+#include <QVector>
+#include "contact.h"
+#include "contactwritequeue.h"
+
+class DatabaseManager;
+class ContactHttpServer;
+class QTcpSocket;
+class QTimer;
+
+struct HttpRequest {
+    QByteArray method;
+    QString path;
+    QUrlQuery query;
+    QHash<QByteArray, QByteArray> headers;   // names lower-cased
+    QByteArray body;
+    bool keepAlive = true;
+};
+
+struct HttpResponse {
+    int status = 200;
+    QByteArray body;   // JSON, or empty
+
+    static HttpResponse json(int status, const QJsonDocument &document);
+    static HttpResponse error(int status, const QString &message);
+};
+
+/**
+ * @brief One persistent HTTP/1.1 connection, owned by a worker thread
+ *
+ * Requests are parsed incrementally and answered strictly in order;
+ * pipelined requests wait in the buffer until the previous response has
+ * been written. Bodies must carry a Content-Length (no chunked uploads).
+ * The connection closes after IdleTimeoutMs without traffic.
+ */
+class HttpConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MaxHeaderBytes = 16 * 1024;
+    static constexpr int MaxBodyBytes = 1024 * 1024;
+    static constexpr int IdleTimeoutMs = 30000;
+
+    HttpConnection(qintptr socketDescriptor, ContactHttpServer *server, QObject *parent = nullptr);
+    bool isValid() const { return m_valid; }
+
+private slots:
+    void onReadyRead();
+
+private:
+    enum ParseResult {
+        NeedMore,
+        Parsed,
+        Invalid
+    };
+
+    ContactHttpServer *m_server;
+    QTcpSocket *m_socket;
+    QTimer *m_idleTimer;
+    QByteArray m_buffer;
+    bool m_valid;
+    bool m_busy;   // a response is being prepared
+
+    void processBuffer();
+    ParseResult parseRequest(HttpRequest *request, int *status);
+    void send(const HttpResponse &response, bool keepAlive);
+};
+
+/**
+ * @brief Event loop host for connections on one worker thread
+ */
+class HttpWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HttpWorker(ContactHttpServer *server) : m_server(server) {}
+
+public slots:
+    void addConnection(qintptr socketDescriptor);
+
+private:
+    ContactHttpServer *m_server;
+};
+
+/**
+ * @brief Embedded HTTP/JSON server over the contact book
+ *
+ * Accepted sockets are spread round-robin over a pool of worker threads,
+ * each running its own event loop, so the GUI thread never parses or
+ * serves a request. Reads go straight to the storage engine, which gives
+ * every worker thread its own connection. Writes are handed to the GUI
+ * thread and queued through DatabaseManager's write-behind API, so the
+ * cache, the signals and the open views stay consistent; the response is
+ * sent once the write has committed.
+ *
+ *   GET    /contacts?limit=&after=     page in sort order; "next" is the
+ *                                      cursor for the following page
+ *   GET    /contacts/search?q=&limit=  ranked prefix search
+ *   GET    /contacts/{id}
+ *   POST   /contacts                   JSON contact, answers 201
+ *   PUT    /contacts/{id}              JSON contact, answers 200
+ *   DELETE /contacts/{id}              answers 204
+ *
+ * Contacts use the same field names as the NDJSON export. The storage
+ * engine must not be replaced while the server is running.
+ */
+class ContactHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultPageSize = 100;
+    static constexpr int MaxPageSize = 1000;
+
+    explicit ContactHttpServer(DatabaseManager *dbManager, QObject *parent = nullptr);
+    ~ContactHttpServer();
+
+    // 0 workers picks one per core, between 2 and 8
+    bool start(quint16 port, const QHostAddress &address = QHostAddress::LocalHost, int workers = 0);
+    void stop();
+
+    // Called from the worker threads
+    QFuture<HttpResponse> handle(const HttpRequest &request);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    DatabaseManager *m_dbManager;
+    QVector<QThread *> m_threads;
+    QVector<HttpWorker *> m_workers;
+    int m_nextWorker;
+
+    HttpResponse listContacts(const HttpRequest &request);
+    HttpResponse searchContacts(const HttpRequest &request);
+    HttpResponse getContact(int id);
+    QFuture<HttpResponse> writeContact(ContactWrite::Kind kind, const Contact &contact);
+};
+
+#endif // CONTACTHTTPSERVER_H
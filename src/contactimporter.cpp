@@ -0,0 +1,443 @@
+#include "contactimporter.h"
+#include "databasemanager.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QDebug>
+#include <memory>
+
+namespace {
+
+/**
+ * Pull-style record reader; next() returns false at end of input.
+ */
+class ContactReader
+{
+public:
+    virtual ~ContactReader() = default;
+    virtual bool next(Contact *contact) = 0;
+};
+
+// ============= CSV =============
+
+class CsvContactReader : public ContactReader
+{
+public:
+    explicit CsvContactReader(QTextStream *stream)
+        : m_stream(stream), m_delimiter(','), m_started(false)
+    {
+        // Positional layout unless a header says otherwise
+        for (int i = 0; i < FieldCount; ++i) m_columns[i] = i;
+    }
+
+    bool next(Contact *contact) override
+    {
+        QStringList fields;
+
+        if (!m_started) {
+            m_started = true;
+            if (!readRecord(&fields, true)) return false;
+            if (mapHeader(fields) && !readRecord(&fields, false)) return false;
+        } else if (!readRecord(&fields, false)) {
+            return false;
+        }
+
+        auto field = [&fields, this](int which) {
+            int column = m_columns[which];
+            return column >= 0 && column < fields.size() ? fields.at(column).trimmed() : QString();
+        };
+
+        *contact = Contact();
+        contact->firstName = field(FirstName);
+        contact->lastName = field(LastName);
+        contact->email = field(Email);
+        contact->phone = field(Phone);
+        contact->city = field(City);
+        contact->country = field(Country);
+        return true;
+    }
+
+private:
+    enum Field { FirstName, LastName, Email, Phone, City, Country, FieldCount };
+
+    QTextStream *m_stream;
+    QChar m_delimiter;
+    bool m_started;
+    int m_columns[FieldCount];
+
+    // Reads one RFC 4180 record, which may span several physical lines
+    // when a quoted field contains line breaks. Blank lines are skipped.
+    bool readRecord(QStringList *fields, bool detectDelimiter)
+    {
+        QString line;
+        do {
+            if (m_stream->atEnd()) return false;
+            line = m_stream->readLine();
+        } while (line.trimmed().isEmpty());
+
+        if (detectDelimiter && line.count(';') > line.count(',')) {
+            m_delimiter = ';';
+        }
+
+        fields->clear();
+        QString field;
+        bool inQuotes = false;
+
+        forever {
+            for (int i = 0; i < line.size(); ++i) {
+                const QChar c = line.at(i);
+                if (inQuotes) {
+                    if (c == '"') {
+                        if (i + 1 < line.size() && line.at(i + 1) == '"') {
+                            field += '"';
+                            ++i;
+                        } else {
+                            inQuotes = false;
+                        }
+                    } else {
+                        field += c;
+                    }
+                } else if (c == '"') {
+                    inQuotes = true;
+                } else if (c == m_delimiter) {
+                    fields->append(field);
+                    field.clear();
+                } else {
+                    field += c;
+                }
+            }
+
+            if (!inQuotes || m_stream->atEnd()) break;
+            field += '\n';
+            line = m_stream->readLine();
+        }
+
+        fields->append(field);
+        return true;
+    }
+
+    // Returns true if the record is a header naming at least both name columns
+    bool mapHeader(const QStringList &header)
+    {
+        int columns[FieldCount];
+        for (int i = 0; i < FieldCount; ++i) columns[i] = -1;
+
+        for (int i = 0; i < header.size(); ++i) {
+            QString key = header.at(i).toLower();
+            key.remove(QRegularExpression("[^a-z]"));
+
+            int which = -1;
+            if (key == "firstname" || key == "first" || key == "givenname" || key == "forename") {
+                which = FirstName;
+            } else if (key == "lastname" || key == "last" || key == "surname" || key == "familyname") {
+                which = LastName;
+            } else if (key == "email" || key == "emailaddress" || key == "mail") {
+                which = Email;
+            } else if (key == "phone" || key == "phonenumber" || key == "telephone"
+                       || key == "tel" || key == "mobile") {
+                which = Phone;
+            } else if (key == "city" || key == "town" || key == "locality") {
+                which = City;
+            } else if (key == "country" || key == "countryname") {
+                which = Country;
+            }
+
+            if (which >= 0 && columns[which] < 0) {
+                columns[which] = i;
+            }
+        }
+
+        if (columns[FirstName] < 0 || columns[LastName] < 0) {
+            return false;
+        }
+
+        for (int i = 0; i < FieldCount; ++i) m_columns[i] = columns[i];
+        return true;
+    }
+};
+
+// ============= vCard =============
+
+class VCardContactReader : public ContactReader
+{
+public:
+    explicit VCardContactReader(QTextStream *stream)
+        : m_stream(stream), m_hasPending(false) {}
+
+    bool next(Contact *contact) override
+    {
+        QString line;
+
+        // Skip ahead to the next card
+        do {
+            if (!readLogicalLine(&line)) return false;
+        } while (line.compare("BEGIN:VCARD", Qt::CaseInsensitive) != 0);
+
+        *contact = Contact();
+        QString formattedName;
+
+        while (readLogicalLine(&line)) {
+            if (line.compare("END:VCARD", Qt::CaseInsensitive) == 0) break;
+
+            int colon = line.indexOf(':');
+            if (colon <= 0) continue;
+
+            QString name = line.left(colon);
+            const QString value = line.mid(colon + 1);
+
+            // Drop parameters (";TYPE=work") and group prefixes ("item1.")
+            int semicolon = name.indexOf(';');
+            if (semicolon >= 0) name.truncate(semicolon);
+            int dot = name.lastIndexOf('.');
+            if (dot >= 0) name = name.mid(dot + 1);
+            name = name.toUpper();
+
+            if (name == "N") {
+                const QStringList parts = splitComponents(value);
+                contact->lastName = parts.value(0).trimmed();
+                contact->firstName = parts.value(1).trimmed();
+            } else if (name == "FN") {
+                formattedName = unescape(value).trimmed();
+            } else if (name == "EMAIL" && contact->email.isEmpty()) {
+                contact->email = unescape(value).trimmed();
+            } else if (name == "TEL" && contact->phone.isEmpty()) {
+                QString phone = unescape(value).trimmed();
+                if (phone.startsWith("tel:", Qt::CaseInsensitive)) phone = phone.mid(4);
+                contact->phone = phone;
+            } else if (name == "ADR" && contact->city.isEmpty() && contact->country.isEmpty()) {
+                // PO box; extended; street; locality; region; postal code; country
+                const QStringList parts = splitComponents(value);
+                contact->city = parts.value(3).trimmed();
+                contact->country = parts.value(6).trimmed();
+            }
+        }
+
+        // Cards without a structured N fall back to splitting FN
+        if (contact->firstName.isEmpty() && contact->lastName.isEmpty() && !formattedName.isEmpty()) {
+            int space = formattedName.lastIndexOf(' ');
+            if (space > 0) {
+                contact->firstName = formattedName.left(space).trimmed();
+                contact->lastName = formattedName.mid(space + 1).trimmed();
+            }
+        }
+
+        return true;
+    }
+
+private:
+    QTextStream *m_stream;
+    QString m_pending;
+    bool m_hasPending;
+
+    // Joins folded continuation lines (RFC 6350 section 3.2)
+    bool readLogicalLine(QString *line)
+    {
+        if (m_hasPending) {
+            *line = m_pending;
+            m_hasPending = false;
+        } else {
+            do {
+                if (m_stream->atEnd()) return false;
+                *line = m_stream->readLine();
+            } while (line->isEmpty());
+        }
+
+        while (!m_stream->atEnd()) {
+            QString nextLine = m_stream->readLine();
+            if (!nextLine.isEmpty() && (nextLine.at(0) == ' ' || nextLine.at(0) == '\t')) {
+                line->append(nextLine.mid(1));
+            } else {
+                m_pending = nextLine;
+                m_hasPending = !nextLine.isEmpty();
+                break;
+            }
+        }
+
+        *line = line->trimmed();
+        return true;
+    }
+
+    static QStringList splitComponents(const QString &value)
+    {
+        QStringList parts;
+        QString current;
+        for (int i = 0; i < value.size(); ++i) {
+            const QChar c = value.at(i);
+            if (c == '\\' && i + 1 < value.size()) {
+                current += c;
+                current += value.at(++i);
+            } else if (c == ';') {
+                parts.append(unescape(current));
+                current.clear();
+            } else {
+                current += c;
+            }
+        }
+        parts.append(unescape(current));
+        return parts;
+    }
+
+    static QString unescape(const QString &value)
+    {
+        QString result;
+        result.reserve(value.size());
+        for (int i = 0; i < value.size(); ++i) {
+            const QChar c = value.at(i);
+            if (c == '\\' && i + 1 < value.size()) {
+                const QChar escaped = value.at(++i);
+                result += (escaped == 'n' || escaped == 'N') ? QChar('\n') : escaped;
+            } else {
+                result += c;
+            }
+        }
+        return result;
+    }
+};
+
+std::unique_ptr<ContactReader> createReader(const QString &filePath, QTextStream *stream)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "csv") {
+        return std::make_unique<CsvContactReader>(stream);
+    }
+    if (suffix == "vcf" || suffix == "vcard") {
+        return std::make_unique<VCardContactReader>(stream);
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// ============= ContactImportWorker =============
+
+ContactImportWorker::ContactImportWorker(DatabaseManager *dbManager,
+                                         const std::atomic<bool> *cancelled)
+    : m_dbManager(dbManager)
+    , m_cancelled(cancelled)
+{
+}
+
+void ContactImportWorker::importFile(const QString &filePath)
+{
+    ImportSummary summary;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        summary.error = "Cannot open " + filePath + ": " + file.errorString();
+        emit finished(summary);
+        return;
+    }
+
+    QTextStream stream(&file);
+    std::unique_ptr<ContactReader> reader = createReader(filePath, &stream);
+    if (!reader) {
+        summary.error = "Unsupported file format: " + filePath;
+        emit finished(summary);
+        return;
+    }
+
+    StorageEngine *engine = m_dbManager->storageEngine();
+    QVector<Contact> batch;
+    batch.reserve(BatchSize);
+
+    auto flush = [&]() {
+        if (batch.isEmpty()) return true;
+        int inserted = engine->insertBatch(batch, &summary.error);
+        if (inserted < 0) return false;
+        summary.imported += inserted;
+        batch.clear();
+        emit progress(file.pos(), file.size(), summary.imported);
+        return true;
+    };
+
+    Contact contact;
+    bool ok = true;
+    while (ok && reader->next(&contact)) {
+        if (m_cancelled->load(std::memory_order_relaxed)) {
+            summary.cancelled = true;
+            break;
+        }
+
+        if (!contact.isValid()) {
+            ++summary.skipped;
+            continue;
+        }
+
+        batch.append(contact);
+        if (batch.size() >= BatchSize) {
+            ok = flush();
+        }
+    }
+
+    if (ok && !summary.cancelled) {
+        flush();
+    }
+
+    qDebug() << "Import finished:" << summary.imported << "imported,"
+             << summary.skipped << "skipped";
+    emit finished(summary);
+}
+
+// ============= ContactImporter =============
+
+ContactImporter::ContactImporter(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(dbManager)
+    , m_running(false)
+    , m_cancelled(false)
+{
+    qRegisterMetaType<ImportSummary>("ImportSummary");
+
+    auto *worker = new ContactImportWorker(m_dbManager, &m_cancelled);
+    worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &ContactImporter::workerImportRequested,
+            worker, &ContactImportWorker::importFile);
+    connect(worker, &ContactImportWorker::progress,
+            this, &ContactImporter::progress);
+    connect(worker, &ContactImportWorker::finished,
+            this, &ContactImporter::onWorkerFinished);
+
+    m_thread.setObjectName("ContactImporter");
+    m_thread.start();
+}
+
+ContactImporter::~ContactImporter()
+{
+    cancel();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool ContactImporter::isSupportedFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    return suffix == "csv" || suffix == "vcf" || suffix == "vcard";
+}
+
+bool ContactImporter::start(const QString &filePath)
+{
+    if (m_running || !m_dbManager->isConnected()) return false;
+
+    m_running = true;
+    m_cancelled = false;
+    emit started(filePath);
+    emit workerImportRequested(filePath);
+    return true;
+}
+
+void ContactImporter::cancel()
+{
+    m_cancelled = true;
+}
+
+void ContactImporter::onWorkerFinished(const ImportSummary &summary)
+{
+    m_running = false;
+    // The worker wrote through the engine; a cancelled or failed import
+    // still committed its earlier batches
+    m_dbManager->notifyContactsImported(summary.imported);
+    emit finished(summary);
+}
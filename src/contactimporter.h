@@ -0,0 +1,91 @@
+#ifndef CONTACTIMPORTER_H
+#define CONTACTIMPORTER_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+
+class DatabaseManager;
+
+/**
+ * @brief Result of a finished (or cancelled) import
+ */
+struct ImportSummary {
+    int imported = 0;
+    int skipped = 0;
+    bool cancelled = false;
+    QString error;
+
+    bool succeeded() const { return error.isEmpty(); }
+};
+
+/**
+ * @brief Streams records from a file into the database
+ *
+ * Lives on the importer's worker thread and writes straight to the
+ * storage engine, which gives this thread its own connection. Records
+ * are parsed one at a time, validated and inserted in batches of
+ * BatchSize rows, each batch all-or-nothing through insertBatch().
+ */
+class ContactImportWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BatchSize = 5000;
+
+    ContactImportWorker(DatabaseManager *dbManager, const std::atomic<bool> *cancelled);
+
+public slots:
+    void importFile(const QString &filePath);
+
+signals:
+    void progress(qint64 bytesRead, qint64 totalBytes, int imported);
+    void finished(const ImportSummary &summary);
+
+private:
+    DatabaseManager *m_dbManager;
+    const std::atomic<bool> *m_cancelled;
+};
+
+/**
+ * @brief Imports CSV and vCard 3/4 files in the background
+ *
+ * The format is picked from the file extension (.csv, .vcf, .vcard).
+ * Only one import runs at a time; progress() is throttled to one update
+ * per batch and finished() is emitted exactly once per import.
+ */
+class ContactImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ContactImporter(DatabaseManager *dbManager, QObject *parent = nullptr);
+    ~ContactImporter();
+
+    bool isRunning() const { return m_running; }
+    static bool isSupportedFile(const QString &filePath);
+
+public slots:
+    bool start(const QString &filePath);
+    void cancel();
+
+signals:
+    void started(const QString &filePath);
+    void progress(qint64 bytesRead, qint64 totalBytes, int imported);
+    void finished(const ImportSummary &summary);
+
+    // Internal: hands the file over to the worker thread
+    void workerImportRequested(const QString &filePath);
+
+private slots:
+    void onWorkerFinished(const ImportSummary &summary);
+
+private:
+    DatabaseManager *m_dbManager;
+    QThread m_thread;
+    bool m_running;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // CONTACTIMPORTER_H
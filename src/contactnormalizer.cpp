@@ -0,0 +1,89 @@
+#include "contactnormalizer.h"
+
+namespace {
+
+// Shorter digit strings are extensions or typos, not phone numbers
+constexpr int MinPhoneDigits = 7;
+// E.164 caps numbers at 15 digits including the country code
+constexpr int MaxPhoneDigits = 15;
+
+} // namespace
+
+QString ContactNormalizer::fold(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (QChar ch : decomposed) {
+        if (!ch.isMark()) folded.append(ch);
+    }
+    return folded.toCaseFolded();
+}
+
+QStringList ContactNormalizer::tokens(const QString &text)
+{
+    QStringList result;
+    const QString folded = fold(text);
+    int start = -1;
+    for (int i = 0; i <= folded.size(); ++i) {
+        bool inToken = i < folded.size() && folded.at(i).isLetterOrNumber();
+        if (inToken && start < 0) {
+            start = i;
+        } else if (!inToken && start >= 0) {
+            result.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return result;
+}
+
+QString ContactNormalizer::name(const QString &text)
+{
+    return tokens(text).join(' ');
+}
+
+QString ContactNormalizer::email(const QString &text)
+{
+    const QString email = text.trimmed().toLower();
+    const int at = email.indexOf('@');
+    if (at <= 0 || at != email.lastIndexOf('@') || at == email.size() - 1) {
+        return QString();
+    }
+    return email;
+}
+
+QString ContactNormalizer::phone(const QString &text, const QString &defaultCountryCode)
+{
+    const QString trimmed = text.trimmed();
+    QString digits;
+    digits.reserve(trimmed.size());
+    for (QChar ch : trimmed) {
+        // Stop at an extension ("x123", "ext. 4")
+        if (ch.isLetter()) break;
+        if (ch.isDigit()) digits.append(QChar('0' + ch.digitValue()));
+    }
+
+    bool international = trimmed.startsWith('+');
+    if (!international && digits.startsWith(QLatin1String("00"))) {
+        digits.remove(0, 2);
+        international = true;
+    }
+
+    if (!international) {
+        // A leading trunk zero is dropped once the country code is added
+        // (UK "020 ..." -> "+44 20 ..."), except where the national plan
+        // itself starts with the country code (NANP "1 555 ...").
+        if (digits.startsWith('1') && defaultCountryCode == QLatin1String("1")
+            && digits.size() == 11) {
+            digits.remove(0, 1);
+        } else if (digits.startsWith('0')) {
+            digits.remove(0, 1);
+        }
+        digits.prepend(defaultCountryCode);
+    }
+
+    if (digits.size() < MinPhoneDigits || digits.size() > MaxPhoneDigits) {
+        return QString();
+    }
+    return QLatin1Char('+') + digits;
+}
@@ -0,0 +1,33 @@
+#ifndef CONTACTNORMALIZER_H
+#define CONTACTNORMALIZER_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Canonical forms of contact fields for matching
+ *
+ * Two values that a person would call "the same" normalize to the same
+ * string: case, diacritics, punctuation and formatting are stripped.
+ * The results are for comparison and indexing only, never for display.
+ */
+class ContactNormalizer
+{
+public:
+    static constexpr const char *DefaultCountryCode = "1";
+
+    // Case-folded with diacritics removed ("Müller" -> "muller")
+    static QString fold(const QString &text);
+    // Folded letter/digit runs, in order ("O'Brien-Smith" -> o, brien, smith)
+    static QStringList tokens(const QString &text);
+    // Folded tokens joined by single spaces
+    static QString name(const QString &text);
+    // Trimmed and lower-cased; empty unless it looks like local@domain
+    static QString email(const QString &text);
+    // E.164-style "+<country><number>"; numbers without an international
+    // prefix get defaultCountryCode. Empty if there are too few digits.
+    static QString phone(const QString &text,
+                         const QString &defaultCountryCode = QLatin1String(DefaultCountryCode));
+};
+
+#endif // CONTACTNORMALIZER_H
@@ -0,0 +1,112 @@
+#include "contactsearcher.h"
+#include "databasemanager.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+// ============= ContactSearchWorker =============
+
+ContactSearchWorker::ContactSearchWorker(DatabaseManager *dbManager,
+                                         const std::atomic<quint64> *latestGeneration)
+    : m_dbManager(dbManager)
+    , m_latestGeneration(latestGeneration)
+{
+}
+
+void ContactSearchWorker::search(quint64 generation, const QString &searchTerm, int limit)
+{
+    // A newer query was queued behind this one; don't bother running it
+    if (isStale(generation)) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<Contact> contacts;
+    QString error;
+    bool ok = m_dbManager->storageEngine()->search(
+        searchTerm, limit, &contacts, &error,
+        [this, generation]() { return isStale(generation); });
+
+    // Superseded searches may have stopped early, so only delivered ones count
+    if (isStale(generation)) return;
+    m_dbManager->histogram(DatabaseManager::SearchContactsOp).record(timer.nsecsElapsed(), !ok);
+
+    if (ok) {
+        emit searchFinished(generation, contacts);
+    } else {
+        emit searchFailed(generation, error);
+    }
+}
+
+bool ContactSearchWorker::isStale(quint64 generation) const
+{
+    return m_latestGeneration->load(std::memory_order_relaxed) != generation;
+}
+
+// ============= ContactSearcher =============
+
+ContactSearcher::ContactSearcher(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(dbManager)
+    , m_resultLimit(-1)
+    , m_generation(0)
+{
+    qRegisterMetaType<QVector<Contact>>("QVector<Contact>");
+
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(DebounceMs);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &ContactSearcher::startSearch);
+
+    auto *worker = new ContactSearchWorker(m_dbManager, &m_generation);
+    worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &ContactSearcher::workerSearchRequested,
+            worker, &ContactSearchWorker::search);
+    connect(worker, &ContactSearchWorker::searchFinished,
+            this, &ContactSearcher::onWorkerFinished);
+    connect(worker, &ContactSearchWorker::searchFailed,
+            this, &ContactSearcher::onWorkerFailed);
+
+    m_thread.setObjectName("ContactSearcher");
+    m_thread.start();
+}
+
+ContactSearcher::~ContactSearcher()
+{
+    cancel();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ContactSearcher::requestSearch(const QString &searchTerm)
+{
+    m_pendingTerm = searchTerm;
+    // Invalidate whatever is in flight; restarting the timer debounces
+    ++m_generation;
+    m_debounceTimer.start();
+}
+
+void ContactSearcher::cancel()
+{
+    m_debounceTimer.stop();
+    ++m_generation;
+}
+
+void ContactSearcher::startSearch()
+{
+    if (!m_dbManager->isConnected()) return;
+
+    quint64 generation = ++m_generation;
+    emit workerSearchRequested(generation, m_pendingTerm, m_resultLimit);
+}
+
+void ContactSearcher::onWorkerFinished(quint64 generation, const QVector<Contact> &contacts)
+{
+    if (generation != m_generation.load()) return;
+    emit resultsReady(m_pendingTerm, contacts);
+}
+
+void ContactSearcher::onWorkerFailed(quint64 generation, const QString &error)
+{
+    if (generation != m_generation.load()) return;
+    qWarning() << "ContactSearcher Error:" << error;
+    emit searchFailed(error);
+}
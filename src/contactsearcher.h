@@ -0,0 +1,88 @@
+#ifndef CONTACTSEARCHER_H
+#define CONTACTSEARCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include "contact.h"
+
+class DatabaseManager;
+
+/**
+ * @brief Runs searches against the storage engine
+ *
+ * Lives on the searcher's worker thread and calls the engine directly;
+ * engines are thread-safe (the SQLite one hands this thread its own
+ * pooled connection). Every request carries a
+ * generation number; a request is dropped, or aborted mid-scan, as soon
+ * as a newer generation has been issued.
+ */
+class ContactSearchWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    ContactSearchWorker(DatabaseManager *dbManager,
+                        const std::atomic<quint64> *latestGeneration);
+
+public slots:
+    void search(quint64 generation, const QString &searchTerm, int limit);
+
+signals:
+    void searchFinished(quint64 generation, const QVector<Contact> &contacts);
+    void searchFailed(quint64 generation, const QString &error);
+
+private:
+    DatabaseManager *m_dbManager;
+    const std::atomic<quint64> *m_latestGeneration;
+
+    bool isStale(quint64 generation) const;
+};
+
+/**
+ * @brief Debounced search-as-you-type front end
+ *
+ * requestSearch() may be called on every keystroke; the query only runs
+ * once input has been idle for DebounceMs. Results of superseded queries
+ * are discarded, so resultsReady() only ever delivers the newest set.
+ */
+class ContactSearcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DebounceMs = 150;
+
+    explicit ContactSearcher(DatabaseManager *dbManager, QObject *parent = nullptr);
+    ~ContactSearcher();
+
+    void setResultLimit(int limit) { m_resultLimit = limit; }
+
+public slots:
+    void requestSearch(const QString &searchTerm);
+    void cancel();
+
+signals:
+    void resultsReady(const QString &searchTerm, const QVector<Contact> &contacts);
+    void searchFailed(const QString &error);
+
+    // Internal: hands a query over to the worker thread
+    void workerSearchRequested(quint64 generation, const QString &searchTerm, int limit);
+
+private slots:
+    void startSearch();
+    void onWorkerFinished(quint64 generation, const QVector<Contact> &contacts);
+    void onWorkerFailed(quint64 generation, const QString &error);
+
+private:
+    DatabaseManager *m_dbManager;
+    QThread m_thread;
+    QTimer m_debounceTimer;
+    QString m_pendingTerm;
+    int m_resultLimit;
+    std::atomic<quint64> m_generation;
+};
+
+#endif // CONTACTSEARCHER_H
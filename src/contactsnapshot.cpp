@@ -0,0 +1,104 @@
+#include "contactsnapshot.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+const quint32 SnapshotMagic = 0x43534e50;   // "CSNP"
+const quint32 SnapshotVersion = 1;
+// Anything larger is not a first page; refuse rather than allocate
+const quint32 MaxSnapshotRows = 10000;
+
+void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+} // namespace
+
+QString ContactSnapshot::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/first-page.snapshot";
+}
+
+bool ContactSnapshot::write(const QString &path, const QString &source,
+                            const QVector<Contact> &contacts, QString *error)
+{
+    if (quint32(contacts.size()) > MaxSnapshotRows) {
+        setError(error, "Too many rows for a snapshot");
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        setError(error, "Cannot open " + path + ": " + file.errorString());
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << SnapshotMagic << SnapshotVersion << source << quint32(contacts.size());
+    for (const Contact &contact : contacts) {
+        out << qint32(contact.id) << contact.firstName << contact.lastName << contact.email
+            << contact.phone << contact.city << contact.country;
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        setError(error, "Failed to write " + path + ": " + file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool ContactSnapshot::read(const QString &path, const QString &source,
+                           QVector<Contact> *contacts, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, "Cannot open " + path + ": " + file.errorString());
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString snapshotSource;
+    quint32 count = 0;
+    in >> magic >> version >> snapshotSource >> count;
+    if (in.status() != QDataStream::Ok || magic != SnapshotMagic || version != SnapshotVersion
+        || count > MaxSnapshotRows) {
+        setError(error, "Not a contact snapshot: " + path);
+        return false;
+    }
+    if (snapshotSource != source) {
+        setError(error, "Snapshot was taken from " + snapshotSource);
+        return false;
+    }
+
+    QVector<Contact> rows;
+    rows.reserve(int(count));
+    for (quint32 i = 0; i < count; ++i) {
+        Contact contact;
+        qint32 id = -1;
+        in >> id >> contact.firstName >> contact.lastName >> contact.email
+           >> contact.phone >> contact.city >> contact.country;
+        contact.id = id;
+        rows.append(contact);
+    }
+    if (in.status() != QDataStream::Ok) {
+        setError(error, "Truncated snapshot: " + path);
+        return false;
+    }
+
+    contacts->append(rows);
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef CONTACTSNAPSHOT_H
+#define CONTACTSNAPSHOT_H
+
+#include <QString>
+#include <QVector>
+#include "contact.h"
+
+/**
+ * @brief Small on-disk copy of the first page of contacts
+ *
+ * Written at shutdown and read at start-up, so the window can show rows
+ * before the database has been opened. The snapshot is only a hint: it
+ * is replaced by the live list as soon as the database is connected.
+ * Each snapshot records the engine it came from; reading it back for a
+ * different one fails.
+ */
+class ContactSnapshot
+{
+public:
+    // Where the GUI keeps its snapshot, in the per-user cache directory
+    static QString defaultPath();
+
+    static bool write(const QString &path, const QString &source,
+                      const QVector<Contact> &contacts, QString *error = nullptr);
+    static bool read(const QString &path, const QString &source,
+                     QVector<Contact> *contacts, QString *error = nullptr);
+};
+
+#endif // CONTACTSNAPSHOT_H
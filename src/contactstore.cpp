@@ -0,0 +1,188 @@
+#include "contactstore.h"
+#include <algorithm>
+
+// ============= StringPool =============
+
+StringPool::StringPool()
+{
+    clear();
+}
+
+quint32 StringPool::intern(const QString &value)
+{
+    if (value.isEmpty()) return 0;
+
+    auto it = m_ids.constFind(value);
+    if (it != m_ids.constEnd()) return it.value();
+
+    const quint32 id = quint32(m_strings.size());
+    m_strings.append(value);
+    m_ids.insert(value, id);
+    return id;
+}
+
+void StringPool::clear()
+{
+    m_ids.clear();
+    m_strings.clear();
+    m_strings.append(QString());
+}
+
+qint64 StringPool::memoryUsage() const
+{
+    qint64 bytes = qint64(m_strings.capacity()) * sizeof(QString);
+    for (const QString &value : m_strings) {
+        bytes += qint64(value.capacity() + 1) * sizeof(QChar);
+    }
+    // Hash nodes hold a second reference to the same string data
+    bytes += qint64(m_ids.capacity()) * (sizeof(QString) + sizeof(quint32));
+    return bytes;
+}
+
+// ============= ContactStore::View =============
+
+int ContactStore::View::id() const
+{
+    return m_store->m_rows.at(m_row).id;
+}
+
+const QString &ContactStore::View::city() const
+{
+    return m_store->m_pool.at(m_store->m_rows.at(m_row).city);
+}
+
+const QString &ContactStore::View::country() const
+{
+    return m_store->m_pool.at(m_store->m_rows.at(m_row).country);
+}
+
+QStringView ContactStore::View::text(int field) const
+{
+    const Row &row = m_store->m_rows.at(m_row);
+    const quint32 begin = field == 0 ? 0 : row.ends[field - 1];
+    const quint32 end = row.ends[field];
+    if (begin == end) return QStringView();
+    return QStringView(m_store->m_blocks[row.block].get() + row.offset + begin, end - begin);
+}
+
+Contact ContactStore::View::toContact() const
+{
+    Contact contact;
+    contact.id = id();
+    contact.firstName = firstName().toString();
+    contact.lastName = lastName().toString();
+    contact.email = email().toString();
+    contact.phone = phone().toString();
+    contact.city = city();
+    contact.country = country();
+    return contact;
+}
+
+// ============= ContactStore =============
+
+ContactStore::ContactStore(const QVector<Contact> &contacts)
+{
+    m_rows.reserve(contacts.size());
+    for (const Contact &contact : contacts) {
+        append(contact);
+    }
+}
+
+void ContactStore::clear()
+{
+    m_rows.clear();
+    m_pool.clear();
+    m_blocks.clear();
+    m_blockSizes.clear();
+    m_currentBlock = -1;
+    m_currentUsed = 0;
+}
+
+int ContactStore::indexOf(int id) const
+{
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (m_rows.at(row).id == id) return row;
+    }
+    return -1;
+}
+
+void ContactStore::append(const Contact &contact)
+{
+    m_rows.append(encode(contact));
+}
+
+void ContactStore::replace(int row, const Contact &contact)
+{
+    m_rows[row] = encode(contact);
+}
+
+void ContactStore::remove(int row)
+{
+    m_rows.remove(row);
+}
+
+void ContactStore::removeIds(const QSet<int> &ids)
+{
+    auto end = std::remove_if(m_rows.begin(), m_rows.end(),
+                              [&ids](const Row &row) { return ids.contains(row.id); });
+    m_rows.erase(end, m_rows.end());
+}
+
+qint64 ContactStore::memoryUsage() const
+{
+    qint64 bytes = qint64(m_rows.capacity()) * sizeof(Row);
+    for (int size : m_blockSizes) {
+        bytes += qint64(size) * sizeof(QChar);
+    }
+    return bytes + m_pool.memoryUsage();
+}
+
+ContactStore::Row ContactStore::encode(const Contact &contact)
+{
+    const QString *fields[TextFieldCount] = {
+        &contact.firstName, &contact.lastName, &contact.email, &contact.phone
+    };
+
+    Row row;
+    row.id = contact.id;
+    row.city = m_pool.intern(contact.city);
+    row.country = m_pool.intern(contact.country);
+
+    int length = 0;
+    for (const QString *field : fields) {
+        length += field->size();
+    }
+
+    QChar *out = allocate(length, &row.block, &row.offset);
+    quint32 end = 0;
+    for (int i = 0; i < TextFieldCount; ++i) {
+        std::copy(fields[i]->constBegin(), fields[i]->constEnd(), out + end);
+        end += quint32(fields[i]->size());
+        row.ends[i] = end;
+    }
+    return row;
+}
+
+QChar *ContactStore::allocate(int length, quint32 *block, quint32 *offset)
+{
+    if (length > BlockSize) {
+        // Oversized rows get a block of their own; the current block stays open
+        m_blocks.push_back(std::make_unique<QChar[]>(length));
+        m_blockSizes.push_back(length);
+        *block = quint32(m_blocks.size() - 1);
+        *offset = 0;
+        return m_blocks.back().get();
+    }
+
+    if (m_currentBlock < 0 || m_currentUsed + length > BlockSize) {
+        m_blocks.push_back(std::make_unique<QChar[]>(BlockSize));
+        m_blockSizes.push_back(BlockSize);
+        m_currentBlock = int(m_blocks.size() - 1);
+        m_currentUsed = 0;
+    }
+
+    *block = quint32(m_currentBlock);
+    *offset = quint32(m_currentUsed);
+    m_currentUsed += length;
+    return m_blocks[m_currentBlock].get() + *offset;
+}
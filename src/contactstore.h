@@ -0,0 +1,125 @@
+#ifndef CONTACTSTORE_H
+#define CONTACTSTORE_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "contact.h"
+
+/**
+ * @brief Interns repeated strings behind 32-bit ids
+ *
+ * Id 0 is always the empty string. Each distinct value is stored once,
+ * so handing out a pooled QString only bumps its reference count.
+ */
+class StringPool
+{
+public:
+    StringPool();
+
+    quint32 intern(const QString &value);
+    const QString &at(quint32 id) const { return m_strings.at(int(id)); }
+    int size() const { return m_strings.size(); }
+    void clear();
+
+    // Approximate heap bytes held by the pool
+    qint64 memoryUsage() const;
+
+private:
+    QHash<QString, quint32> m_ids;
+    QVector<QString> m_strings;
+};
+
+/**
+ * @brief Column-compact storage for a materialized list of contacts
+ *
+ * A QVector<Contact> costs seven separately allocated QStrings per row.
+ * Here city and country, which repeat heavily, are interned in a
+ * StringPool, and the remaining text of a row is copied back to back
+ * into large arena blocks. A row is then a fixed-size record of offsets
+ * and pool ids, so a result set of n rows costs n records plus a handful
+ * of block allocations.
+ *
+ * Rows are read through lightweight View objects; a full Contact is only
+ * built when contact() or View::toContact() is called. Replacing or
+ * removing rows leaves their old text in the arena until clear().
+ */
+class ContactStore
+{
+public:
+    class View
+    {
+    public:
+        int id() const;
+        QStringView firstName() const { return text(0); }
+        QStringView lastName() const { return text(1); }
+        QStringView email() const { return text(2); }
+        QStringView phone() const { return text(3); }
+        const QString &city() const;
+        const QString &country() const;
+
+        Contact toContact() const;
+
+    private:
+        friend class ContactStore;
+        View(const ContactStore *store, int row) : m_store(store), m_row(row) {}
+
+        QStringView text(int field) const;
+
+        const ContactStore *m_store;
+        int m_row;
+    };
+
+    // Characters per arena block; longer rows get a block of their own
+    static constexpr int BlockSize = 32 * 1024;
+
+    ContactStore() = default;
+    explicit ContactStore(const QVector<Contact> &contacts);
+
+    int size() const { return m_rows.size(); }
+    bool isEmpty() const { return m_rows.isEmpty(); }
+    void reserve(int rows) { m_rows.reserve(rows); }
+    void clear();
+
+    View at(int row) const { return View(this, row); }
+    Contact contact(int row) const { return at(row).toContact(); }
+    // Row holding the contact with this id, or -1
+    int indexOf(int id) const;
+
+    void append(const Contact &contact);
+    void replace(int row, const Contact &contact);
+    void remove(int row);
+    // Drops every row whose id is in ids, keeping the order of the rest
+    void removeIds(const QSet<int> &ids);
+
+    // Approximate heap bytes held by the store
+    qint64 memoryUsage() const;
+
+private:
+    enum { TextFieldCount = 4 };
+
+    struct Row {
+        int id;
+        quint32 block;
+        quint32 offset;
+        quint32 ends[TextFieldCount];   // relative to offset
+        quint32 city;
+        quint32 country;
+    };
+
+    QVector<Row> m_rows;
+    StringPool m_pool;
+    std::vector<std::unique_ptr<QChar[]>> m_blocks;
+    std::vector<int> m_blockSizes;
+    int m_currentBlock = -1;
+    int m_currentUsed = 0;
+
+    Row encode(const Contact &contact);
+    QChar *allocate(int length, quint32 *block, quint32 *offset);
+};
+
+#endif // CONTACTSTORE_H
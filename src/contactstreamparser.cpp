@@ -0,0 +1,193 @@
+#include "contactstreamparser.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+// Depth of the "results" array: root object, then the array
+const int ResultsDepth = 2;
+
+Contact contactFromJson(const QJsonObject &user)
+{
+    Contact contact;
+
+    // Extract name
+    if (user.contains("name") && user["name"].isObject()) {
+        QJsonObject name = user["name"].toObject();
+        contact.firstName = name["first"].toString();
+        contact.lastName = name["last"].toString();
+    }
+
+    // Extract email
+    if (user.contains("email")) {
+        contact.email = user["email"].toString();
+    }
+
+    // Extract phone
+    if (user.contains("phone")) {
+        contact.phone = user["phone"].toString();
+    }
+
+    // Extract location
+    if (user.contains("location") && user["location"].isObject()) {
+        QJsonObject location = user["location"].toObject();
+
+        if (location.contains("city")) {
+            contact.city = location["city"].toString();
+        }
+
+        if (location.contains("country")) {
+            contact.country = location["country"].toString();
+        }
+    }
+
+    return contact;
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+ContactStreamParser::ContactStreamParser(std::function<void(const Contact &)> onContact)
+    : m_onContact(std::move(onContact))
+{
+    reset();
+}
+
+void ContactStreamParser::reset()
+{
+    m_depth = 0;
+    m_inString = false;
+    m_escape = false;
+    m_started = false;
+    m_expectingKey = false;
+    m_key.clear();
+    m_inResults = false;
+    m_sawResults = false;
+    m_capturing = false;
+    m_element.clear();
+    m_contacts = 0;
+    m_error.clear();
+}
+
+bool ContactStreamParser::feed(QByteArrayView chunk)
+{
+    if (!m_error.isEmpty()) return false;
+
+    // Start of the current element within this chunk, or -1
+    qsizetype captureFrom = m_capturing ? 0 : -1;
+
+    for (qsizetype i = 0; i < chunk.size(); ++i) {
+        const char c = chunk[i];
+
+        if (m_inString) {
+            const bool inKey = m_depth == 1 && m_expectingKey;
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+                continue;
+            }
+            if (inKey && m_key.size() < MaxKeyBytes) {
+                m_key.append(c);
+            }
+            continue;
+        }
+
+        if (isSpace(c)) continue;
+        if (!m_started) {
+            if (c != '{') return fail("Response is not a JSON object");
+            m_started = true;
+            m_expectingKey = true;
+        } else if (m_depth == 0) {
+            return fail("Unexpected data after the response");
+        }
+
+        switch (c) {
+        case '"':
+            m_inString = true;
+            if (m_depth == 1 && m_expectingKey) {
+                m_key.clear();
+            }
+            break;
+        case '{':
+        case '[':
+            ++m_depth;
+            if (m_depth == ResultsDepth && c == '[' && m_key == "results") {
+                m_inResults = true;
+                m_sawResults = true;
+            } else if (m_inResults && m_depth == ResultsDepth + 1) {
+                m_capturing = true;
+                captureFrom = i;
+            }
+            break;
+        case '}':
+        case ']':
+            if (m_depth == 0) return fail("Unbalanced brackets in response");
+            --m_depth;
+            if (m_capturing && m_depth == ResultsDepth) {
+                m_element.append(chunk.sliced(captureFrom, i - captureFrom + 1));
+                m_capturing = false;
+                captureFrom = -1;
+                emitElement();
+            } else if (m_inResults && m_depth < ResultsDepth) {
+                m_inResults = false;
+            }
+            break;
+        case ':':
+            if (m_depth == 1) m_expectingKey = false;
+            break;
+        case ',':
+            if (m_depth == 1) m_expectingKey = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (m_capturing) {
+        m_element.append(chunk.sliced(captureFrom));
+    }
+    if (m_element.size() > MaxElementBytes) {
+        return fail("Result element too large");
+    }
+    return true;
+}
+
+bool ContactStreamParser::finish()
+{
+    if (!m_error.isEmpty()) return false;
+    if (!m_started || m_depth != 0 || m_inString) {
+        return fail("Truncated response");
+    }
+    if (!m_sawResults) {
+        return fail("No results array in response");
+    }
+    return true;
+}
+
+bool ContactStreamParser::fail(const QString &error)
+{
+    m_error = error;
+    m_element.clear();
+    m_capturing = false;
+    return false;
+}
+
+void ContactStreamParser::emitElement()
+{
+    const QJsonDocument document = QJsonDocument::fromJson(m_element);
+    m_element.clear();
+    if (!document.isObject()) return;
+
+    const Contact contact = contactFromJson(document.object());
+    if (!contact.isValid()) return;
+
+    ++m_contacts;
+    m_onContact(contact);
+}
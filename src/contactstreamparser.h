@@ -0,0 +1,59 @@
+#ifndef CONTACTSTREAMPARSER_H
+#define CONTACTSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <functional>
+#include "contact.h"
+
+/**
+ * @brief Incremental reader for RandomUser.me style responses
+ *
+ * Takes the body in arbitrary chunks, e.g. from QNetworkReply::readyRead,
+ * and hands each element of the top-level "results" array to the callback
+ * as soon as its closing brace arrives. Only the element being read is
+ * buffered, so memory stays bounded by MaxElementBytes however large the
+ * response. Everything outside "results" is scanned but not kept.
+ *
+ * Elements are decoded with the same field mapping the GUI always used;
+ * an element that does not yield a valid contact is skipped.
+ */
+class ContactStreamParser
+{
+public:
+    static constexpr int MaxElementBytes = 1024 * 1024;
+    static constexpr int MaxKeyBytes = 64;
+
+    explicit ContactStreamParser(std::function<void(const Contact &)> onContact);
+
+    // False once the input is known to be malformed; later chunks are ignored
+    bool feed(QByteArrayView chunk);
+    // Call after the last chunk; false if the document was incomplete or
+    // had no "results" array
+    bool finish();
+
+    QString errorString() const { return m_error; }
+    int contactCount() const { return m_contacts; }
+    void reset();
+
+private:
+    std::function<void(const Contact &)> m_onContact;
+    int m_depth;            // open objects and arrays
+    bool m_inString;
+    bool m_escape;
+    bool m_started;         // seen the root object
+    bool m_expectingKey;    // next string at depth 1 is a key
+    QByteArray m_key;       // last key at depth 1
+    bool m_inResults;       // inside the "results" array (depth 2)
+    bool m_sawResults;
+    bool m_capturing;       // inside a results element
+    QByteArray m_element;
+    int m_contacts;
+    QString m_error;
+
+    bool fail(const QString &error);
+    void emitElement();
+};
+
+#endif // CONTACTSTREAMPARSER_H
@@ -0,0 +1,520 @@
+#include "contacttablemodel.h"
+#include "databasemanager.h"
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// Mirrors ORDER BY first_name, last_name, id
+int compareKeys(const QString &firstA, const QString &lastA, int idA,
+                const QString &firstB, const QString &lastB, int idB)
+{
+    if (int c = QString::compare(firstA, firstB)) return c;
+    if (int c = QString::compare(lastA, lastB)) return c;
+    return idA < idB ? -1 : (idA > idB ? 1 : 0);
+}
+
+bool sameSortKey(const Contact &a, const Contact &b)
+{
+    return a.id == b.id && a.firstName == b.firstName && a.lastName == b.lastName;
+}
+
+} // namespace
+
+ContactTableModel::ContactTableModel(DatabaseManager *dbManager, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_dbManager(dbManager)
+    , m_paged(false)
+    , m_exhausted(true)
+    , m_loadedRows(0)
+{
+}
+
+bool ContactTableModel::lessThan(const Contact &a, const Contact &b)
+{
+    return compareKeys(a.firstName, a.lastName, a.id, b.firstName, b.lastName, b.id) < 0;
+}
+
+void ContactTableModel::reload()
+{
+    beginResetModel();
+    m_fixedRows.clear();
+    m_paged = true;
+    resetPaging();
+    m_exhausted = false;
+    endResetModel();
+
+    // Expose the first page right away so the view has something to show
+    if (canFetchMore(QModelIndex())) {
+        fetchMore(QModelIndex());
+    }
+}
+
+void ContactTableModel::setContacts(const QVector<Contact> &contacts)
+{
+    beginResetModel();
+    m_paged = false;
+    resetPaging();
+    m_fixedRows.clear();
+    m_fixedRows.reserve(contacts.size());
+    for (const Contact &contact : contacts) {
+        m_fixedRows.append(contact);
+    }
+    endResetModel();
+}
+
+void ContactTableModel::clear()
+{
+    beginResetModel();
+    m_paged = false;
+    resetPaging();
+    m_fixedRows.clear();
+    endResetModel();
+}
+
+Contact ContactTableModel::contactAt(int row) const
+{
+    if (!m_paged) {
+        return row >= 0 && row < m_fixedRows.size() ? m_fixedRows.contact(row) : Contact();
+    }
+
+    const Contact *contact = rowPointer(row);
+    return contact ? *contact : Contact();
+}
+
+int ContactTableModel::rowOf(const Contact &contact) const
+{
+    if (!m_paged) {
+        return m_fixedRows.indexOf(contact.id);
+    }
+
+    int pageIndex = pageForKey(contact);
+    if (pageIndex >= m_pageKeys.size()) return -1;
+
+    int offset = offsetInPage(pageIndex, contact);
+    if (offset >= m_pageSizes.at(pageIndex)) return -1;
+    return pageStart(pageIndex) + offset;
+}
+
+int ContactTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_paged ? m_loadedRows : m_fixedRows.size();
+}
+
+int ContactTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ContactTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    if (role != Qt::DisplayRole && role != IdRole) return QVariant();
+
+    if (!m_paged) {
+        return fixedRowData(index, role);
+    }
+
+    const Contact *contact = rowPointer(index.row());
+    if (!contact) return QVariant();
+
+    if (role == IdRole) {
+        return contact->id;
+    }
+
+    switch (index.column()) {
+    case FirstNameColumn: return contact->firstName;
+    case LastNameColumn:  return contact->lastName;
+    case EmailColumn:     return contact->email;
+    case PhoneColumn:     return contact->phone;
+    case CityColumn:      return contact->city;
+    case CountryColumn:   return contact->country;
+    default:              return QVariant();
+    }
+}
+
+QVariant ContactTableModel::fixedRowData(const QModelIndex &index, int role) const
+{
+    if (index.row() >= m_fixedRows.size()) return QVariant();
+
+    // Only the requested field is turned into a QString
+    const ContactStore::View contact = m_fixedRows.at(index.row());
+    if (role == IdRole) {
+        return contact.id();
+    }
+
+    switch (index.column()) {
+    case FirstNameColumn: return contact.firstName().toString();
+    case LastNameColumn:  return contact.lastName().toString();
+    case EmailColumn:     return contact.email().toString();
+    case PhoneColumn:     return contact.phone().toString();
+    case CityColumn:      return contact.city();
+    case CountryColumn:   return contact.country();
+    default:              return QVariant();
+    }
+}
+
+QVariant ContactTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Vertical) return section + 1;
+
+    switch (section) {
+    case FirstNameColumn: return tr("First Name");
+    case LastNameColumn:  return tr("Last Name");
+    case EmailColumn:     return tr("Email");
+    case PhoneColumn:     return tr("Phone");
+    case CityColumn:      return tr("City");
+    case CountryColumn:   return tr("Country");
+    default:              return QVariant();
+    }
+}
+
+bool ContactTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return false;
+    return m_paged && !m_exhausted;
+}
+
+void ContactTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) return;
+
+    const int pageIndex = m_pageKeys.size();
+    QVector<Contact> rows = loadPage(pageIndex);
+
+    if (rows.size() < PageSize) {
+        m_exhausted = true;
+    }
+    if (rows.isEmpty()) return;
+
+    const Contact &last = rows.constLast();
+
+    beginInsertRows(QModelIndex(), m_loadedRows, m_loadedRows + rows.size() - 1);
+    m_pageKeys.append({last.firstName, last.lastName, last.id});
+    appendPageSize(rows.size());
+    m_loadedRows += rows.size();
+    cachePage(pageIndex, rows);
+    endInsertRows();
+}
+
+// ============= Incremental updates =============
+
+void ContactTableModel::onContactAdded(const Contact &contact)
+{
+    // Search results are a filtered snapshot; new rows may not match
+    if (!m_paged) return;
+
+    insertPagedRow(contact);
+}
+
+void ContactTableModel::onContactUpdated(const Contact &previous, const Contact &current)
+{
+    if (!m_paged) {
+        // Search results are capped, a linear scan is fine here
+        int row = m_fixedRows.indexOf(current.id);
+        if (row >= 0) {
+            m_fixedRows.replace(row, current);
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        }
+        return;
+    }
+
+    if (!sameSortKey(previous, current)) {
+        // The row moves; let the view see it as a removal plus an insert
+        removePagedRow(previous);
+        insertPagedRow(current);
+        return;
+    }
+
+    int pageIndex = pageForKey(previous);
+    if (pageIndex >= m_pageKeys.size()) return;
+
+    int offset = offsetInPage(pageIndex, previous);
+    if (offset >= m_pageSizes.at(pageIndex)) return;
+
+    auto it = m_pages.find(pageIndex);
+    if (it != m_pages.end() && offset < it->size()) {
+        (*it)[offset] = current;
+    }
+
+    int row = pageStart(pageIndex) + offset;
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void ContactTableModel::onContactDeleted(const Contact &contact)
+{
+    if (!m_paged) {
+        int row = m_fixedRows.indexOf(contact.id);
+        if (row >= 0) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_fixedRows.remove(row);
+            endRemoveRows();
+        }
+        return;
+    }
+
+    removePagedRow(contact);
+}
+
+void ContactTableModel::onContactsUpdated(const QVector<Contact> &previous,
+                                          const QVector<Contact> &current)
+{
+    if (!m_paged) {
+        QHash<int, int> rows;
+        for (int row = 0; row < m_fixedRows.size(); ++row) {
+            rows.insert(m_fixedRows.at(row).id(), row);
+        }
+
+        int first = m_fixedRows.size();
+        int last = -1;
+        for (const Contact &contact : current) {
+            auto it = rows.constFind(contact.id);
+            if (it == rows.constEnd()) continue;
+            m_fixedRows.replace(*it, contact);
+            first = qMin(first, *it);
+            last = qMax(last, *it);
+        }
+        if (last >= 0) {
+            emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+        }
+        return;
+    }
+
+    if (current.size() > BulkReloadThreshold) {
+        reload();
+        return;
+    }
+    for (int i = 0; i < current.size(); ++i) {
+        onContactUpdated(previous.at(i), current.at(i));
+    }
+}
+
+void ContactTableModel::onContactsDeleted(const QVector<Contact> &contacts)
+{
+    if (!m_paged) {
+        QSet<int> ids;
+        for (const Contact &contact : contacts) {
+            ids.insert(contact.id);
+        }
+        beginResetModel();
+        m_fixedRows.removeIds(ids);
+        endResetModel();
+        return;
+    }
+
+    if (contacts.size() > BulkReloadThreshold) {
+        reload();
+        return;
+    }
+    for (const Contact &contact : contacts) {
+        removePagedRow(contact);
+    }
+}
+
+void ContactTableModel::insertPagedRow(const Contact &contact)
+{
+    int pageIndex = pageForKey(contact);
+
+    if (pageIndex == m_pageKeys.size()) {
+        // Sorts after every loaded row; fetchMore() will reach it later
+        if (!m_exhausted) return;
+
+        if (pageIndex == 0) {
+            beginInsertRows(QModelIndex(), 0, 0);
+            m_pageKeys.append({contact.firstName, contact.lastName, contact.id});
+            appendPageSize(1);
+            m_loadedRows = 1;
+            cachePage(0, {contact});
+            endInsertRows();
+            return;
+        }
+
+        // Everything is loaded, so the row extends the last page
+        pageIndex -= 1;
+        m_pageKeys[pageIndex] = {contact.firstName, contact.lastName, contact.id};
+    }
+
+    int offset = offsetInPage(pageIndex, contact);
+    int row = pageStart(pageIndex) + offset;
+
+    beginInsertRows(QModelIndex(), row, row);
+    auto it = m_pages.find(pageIndex);
+    if (it != m_pages.end()) {
+        it->insert(offset, contact);
+    }
+    adjustPageSize(pageIndex, 1);
+    ++m_loadedRows;
+    endInsertRows();
+}
+
+void ContactTableModel::removePagedRow(const Contact &contact)
+{
+    int pageIndex = pageForKey(contact);
+    if (pageIndex >= m_pageKeys.size()) return;
+
+    int offset = offsetInPage(pageIndex, contact);
+    if (offset >= m_pageSizes.at(pageIndex)) return;
+
+    auto it = m_pages.find(pageIndex);
+    if (it != m_pages.end() && (offset >= it->size() || it->at(offset).id != contact.id)) {
+        return;
+    }
+
+    int row = pageStart(pageIndex) + offset;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    if (it != m_pages.end()) {
+        it->remove(offset);
+    }
+    adjustPageSize(pageIndex, -1);
+    --m_loadedRows;
+    endRemoveRows();
+}
+
+int ContactTableModel::pageForKey(const Contact &contact) const
+{
+    // First page whose last key is not before the contact
+    auto it = std::lower_bound(m_pageKeys.constBegin(), m_pageKeys.constEnd(), contact,
+                               [](const PageKey &key, const Contact &c) {
+                                   return compareKeys(key.firstName, key.lastName, key.id,
+                                                      c.firstName, c.lastName, c.id) < 0;
+                               });
+    return int(it - m_pageKeys.constBegin());
+}
+
+int ContactTableModel::offsetInPage(int pageIndex, const Contact &contact) const
+{
+    // Cached pages reflect what the view shows. Otherwise the page is read
+    // from the database only to count the rows sorting before the contact,
+    // which is the same before and after the mutation, and not cached.
+    QVector<Contact> loaded;
+    const QVector<Contact> *rows = nullptr;
+
+    auto it = m_pages.constFind(pageIndex);
+    if (it != m_pages.constEnd()) {
+        rows = &it.value();
+    } else {
+        loaded = loadPage(pageIndex);
+        rows = &loaded;
+    }
+
+    auto pos = std::lower_bound(rows->constBegin(), rows->constEnd(), contact, &ContactTableModel::lessThan);
+    return int(pos - rows->constBegin());
+}
+
+// ============= Paging =============
+
+const Contact *ContactTableModel::rowPointer(int row) const
+{
+    if (row < 0 || !m_paged || row >= m_loadedRows) return nullptr;
+
+    int offset = 0;
+    int pageIndex = pageForRow(row, &offset);
+    if (pageIndex < 0) return nullptr;
+
+    const QVector<Contact> *rows = page(pageIndex);
+    if (!rows || offset >= rows->size()) return nullptr;
+    return &rows->at(offset);
+}
+
+const QVector<Contact> *ContactTableModel::page(int pageIndex) const
+{
+    auto it = m_pages.constFind(pageIndex);
+    if (it != m_pages.constEnd()) {
+        // Mark as most recently used
+        m_pageLru.removeOne(pageIndex);
+        m_pageLru.append(pageIndex);
+        return &it.value();
+    }
+
+    cachePage(pageIndex, loadPage(pageIndex));
+    return &m_pages[pageIndex];
+}
+
+QVector<Contact> ContactTableModel::loadPage(int pageIndex) const
+{
+    Contact after;
+    if (pageIndex > 0 && pageIndex - 1 < m_pageKeys.size()) {
+        const PageKey &key = m_pageKeys.at(pageIndex - 1);
+        after.id = key.id;
+        after.firstName = key.firstName;
+        after.lastName = key.lastName;
+    }
+
+    // Known pages may have grown or shrunk through in-place updates
+    int limit = pageIndex < m_pageSizes.size() ? m_pageSizes.at(pageIndex) : PageSize;
+    if (limit <= 0) return QVector<Contact>();
+
+    return m_dbManager->getContactsPage(after, limit);
+}
+
+void ContactTableModel::cachePage(int pageIndex, const QVector<Contact> &rows) const
+{
+    m_pages.insert(pageIndex, rows);
+    m_pageLru.removeOne(pageIndex);
+    m_pageLru.append(pageIndex);
+
+    while (m_pageLru.size() > MaxCachedPages) {
+        m_pages.remove(m_pageLru.takeFirst());
+    }
+}
+
+void ContactTableModel::resetPaging()
+{
+    m_exhausted = true;
+    m_loadedRows = 0;
+    m_pageKeys.clear();
+    m_pageSizes.clear();
+    m_pageTree.clear();
+    m_pages.clear();
+    m_pageLru.clear();
+}
+
+// ============= Fenwick tree over page sizes =============
+
+void ContactTableModel::appendPageSize(int size)
+{
+    // Node i (1-based) covers pages (i - lowbit(i), i]
+    const int node = m_pageSizes.size() + 1;
+    m_pageSizes.append(size);
+    m_pageTree.append(size + pageStart(node - 1) - pageStart(node - (node & -node)));
+}
+
+void ContactTableModel::adjustPageSize(int pageIndex, int delta)
+{
+    m_pageSizes[pageIndex] += delta;
+    for (int node = pageIndex + 1; node <= m_pageTree.size(); node += node & -node) {
+        m_pageTree[node - 1] += delta;
+    }
+}
+
+int ContactTableModel::pageStart(int pageIndex) const
+{
+    int sum = 0;
+    for (int node = pageIndex; node > 0; node -= node & -node) {
+        sum += m_pageTree.at(node - 1);
+    }
+    return sum;
+}
+
+int ContactTableModel::pageForRow(int row, int *offset) const
+{
+    const int count = m_pageTree.size();
+    int step = 1;
+    while (step * 2 <= count) step *= 2;
+
+    int node = 0;
+    int remaining = row;
+    for (; step > 0; step /= 2) {
+        if (node + step <= count && m_pageTree.at(node + step - 1) <= remaining) {
+            node += step;
+            remaining -= m_pageTree.at(node - 1);
+        }
+    }
+
+    if (node >= count) return -1;
+    *offset = remaining;
+    return node;
+}
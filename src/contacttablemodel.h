@@ -0,0 +1,130 @@
+#ifndef CONTACTTABLEMODEL_H
+#define CONTACTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include "contact.h"
+#include "contactstore.h"
+
+class DatabaseManager;
+
+/**
+ * @brief Lazily populated table model over the contacts table
+ *
+ * In paged mode rows are pulled from the database in pages using keyset
+ * pagination on (first_name, last_name, id). The view grows the row count
+ * through canFetchMore()/fetchMore(), while only a small LRU window of
+ * pages is kept in memory; evicted pages are re-read from the stored key
+ * of the preceding page when they scroll back into view.
+ *
+ * Single-row mutations are applied in place: the affected page is found
+ * by binary search over the page keys and row offsets are kept in a
+ * Fenwick tree, so an insert, update or removal costs O(log n) instead of
+ * a reload.
+ *
+ * A fixed result set (e.g. search results) can be shown instead with
+ * setContacts(); it is kept in a ContactStore rather than as Contacts.
+ */
+class ContactTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        FirstNameColumn,
+        LastNameColumn,
+        EmailColumn,
+        PhoneColumn,
+        CityColumn,
+        CountryColumn,
+        ColumnCount
+    };
+
+    enum Role {
+        IdRole = Qt::UserRole
+    };
+
+    static constexpr int PageSize = 256;
+    static constexpr int MaxCachedPages = 16;
+    // Bulk changes larger than this reload paged mode instead of being
+    // applied row by row
+    static constexpr int BulkReloadThreshold = PageSize;
+
+    explicit ContactTableModel(DatabaseManager *dbManager, QObject *parent = nullptr);
+
+    // Switch to paged mode and start again from the first page
+    void reload();
+    // Show a fixed, already materialized set of contacts
+    void setContacts(const QVector<Contact> &contacts);
+    void clear();
+
+    bool isPaged() const { return m_paged; }
+    Contact contactAt(int row) const;
+    // Row of an already loaded contact, or -1
+    int rowOf(const Contact &contact) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // Sort order shared with the database queries
+    static bool lessThan(const Contact &a, const Contact &b);
+
+public slots:
+    void onContactAdded(const Contact &contact);
+    void onContactUpdated(const Contact &previous, const Contact &current);
+    void onContactDeleted(const Contact &contact);
+    void onContactsUpdated(const QVector<Contact> &previous, const QVector<Contact> &current);
+    void onContactsDeleted(const QVector<Contact> &contacts);
+
+private:
+    // Sort key of the last row of a page, used as the keyset cursor
+    struct PageKey {
+        QString firstName;
+        QString lastName;
+        int id;
+    };
+
+    DatabaseManager *m_dbManager;
+    bool m_paged;
+    bool m_exhausted;
+    int m_loadedRows;
+    QVector<PageKey> m_pageKeys;
+    QVector<int> m_pageSizes;
+    QVector<int> m_pageTree;    // Fenwick tree over m_pageSizes
+
+    mutable QHash<int, QVector<Contact>> m_pages;
+    mutable QList<int> m_pageLru;
+
+    ContactStore m_fixedRows;
+
+    // Paged mode only; fixed rows are read through ContactStore views
+    const Contact *rowPointer(int row) const;
+    QVariant fixedRowData(const QModelIndex &index, int role) const;
+    const QVector<Contact> *page(int pageIndex) const;
+    QVector<Contact> loadPage(int pageIndex) const;
+    void cachePage(int pageIndex, const QVector<Contact> &rows) const;
+    void resetPaging();
+
+    // Locating rows in paged mode
+    int pageForKey(const Contact &contact) const;
+    int offsetInPage(int pageIndex, const Contact &contact) const;
+
+    // Fenwick tree helpers
+    void appendPageSize(int size);
+    void adjustPageSize(int pageIndex, int delta);
+    int pageStart(int pageIndex) const;
+    int pageForRow(int row, int *offset) const;
+
+    void insertPagedRow(const Contact &contact);
+    void removePagedRow(const Contact &contact);
+};
+
+#endif // CONTACTTABLEMODEL_H
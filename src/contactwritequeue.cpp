@@ -0,0 +1,187 @@
+#include "contactwritequeue.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <utility>
+
+ContactWriteQueue::ContactWriteQueue(StorageEngine *engine, QObject *parent)
+    : QObject(parent)
+    , m_engine(engine)
+    , m_thread(nullptr)
+    , m_maxBatchSize(DefaultMaxBatchSize)
+    , m_maxLatencyMs(DefaultMaxLatencyMs)
+    , m_enqueued(0)
+    , m_committedCount(0)
+    , m_flushTarget(0)
+    , m_stopping(false)
+{
+    qRegisterMetaType<WriteResult>("WriteResult");
+
+    m_clock.start();
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("ContactWriteQueue");
+    m_thread->start();
+}
+
+ContactWriteQueue::~ContactWriteQueue()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_queued.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+
+    for (CompletedWrite &completed : m_completed) {
+        completed.resolve();
+    }
+}
+
+void ContactWriteQueue::setMaxBatchSize(int writes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBatchSize = qMax(1, writes);
+    m_queued.wakeAll();
+}
+
+int ContactWriteQueue::maxBatchSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxBatchSize;
+}
+
+void ContactWriteQueue::setMaxLatency(int milliseconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxLatencyMs = qMax(0, milliseconds);
+    m_queued.wakeAll();
+}
+
+int ContactWriteQueue::maxLatency() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxLatencyMs;
+}
+
+QFuture<WriteResult> ContactWriteQueue::enqueue(const ContactWrite &write)
+{
+    PendingWrite pending;
+    pending.write = write;
+    pending.enqueuedNs = m_clock.nsecsElapsed();
+    pending.enqueuedAt = pending.enqueuedNs / 1000000;
+    pending.promise.start();
+    QFuture<WriteResult> future = pending.promise.future();
+
+    QMutexLocker locker(&m_mutex);
+    m_pending.push_back(std::move(pending));
+    ++m_enqueued;
+    m_queued.wakeAll();
+    return future;
+}
+
+void ContactWriteQueue::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 target = m_enqueued;
+    if (m_committedCount >= target) return;
+
+    m_flushTarget = qMax(m_flushTarget, target);
+    m_queued.wakeAll();
+    while (m_committedCount < target) {
+        m_committed.wait(&m_mutex);
+    }
+}
+
+int ContactWriteQueue::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_enqueued - m_committedCount);
+}
+
+std::deque<CompletedWrite> ContactWriteQueue::takeCompleted()
+{
+    QMutexLocker locker(&m_mutex);
+    std::deque<CompletedWrite> completed;
+    completed.swap(m_completed);
+    return completed;
+}
+
+// ============= Writer thread =============
+
+void ContactWriteQueue::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    forever {
+        while (m_pending.empty() && !m_stopping) {
+            m_queued.wait(&m_mutex);
+        }
+        if (m_pending.empty()) break;   // stopping with nothing left
+
+        // Give the batch until the oldest write's deadline to fill up
+        while (int(m_pending.size()) < m_maxBatchSize && !m_stopping
+               && m_flushTarget <= m_committedCount) {
+            const qint64 remaining = m_pending.front().enqueuedAt + m_maxLatencyMs - m_clock.elapsed();
+            if (remaining <= 0) break;
+            m_queued.wait(&m_mutex, ulong(remaining));
+        }
+
+        std::deque<PendingWrite> batch;
+        const int take = qMin(int(m_pending.size()), m_maxBatchSize);
+        for (int i = 0; i < take; ++i) {
+            batch.push_back(std::move(m_pending.front()));
+            m_pending.pop_front();
+        }
+
+        locker.unlock();
+        commit(batch);
+        locker.relock();
+
+        m_committedCount += batch.size();
+        m_committed.wakeAll();
+    }
+}
+
+void ContactWriteQueue::commit(std::deque<PendingWrite> &batch)
+{
+    QVector<ContactWrite> writes;
+    writes.reserve(int(batch.size()));
+    for (const PendingWrite &pending : batch) {
+        writes.append(pending.write);
+    }
+
+    QString error;
+    const bool ok = m_engine->applyWrites(&writes, &error);
+    const qint64 committedNs = m_clock.nsecsElapsed();
+    if (!ok) {
+        qWarning() << "Group commit of" << writes.size() << "writes failed:" << error;
+    }
+
+    std::deque<CompletedWrite> completed;
+    for (int i = 0; i < writes.size(); ++i) {
+        const ContactWrite &write = writes.at(i);
+
+        CompletedWrite done;
+        WriteResult &result = done.result;
+        result.kind = write.kind;
+        result.contact = write.contact;
+        result.previous = write.previous;
+        result.latencyNs = committedNs - batch[i].enqueuedNs;
+        if (!ok) {
+            result.error = error;
+        } else if (!write.applied) {
+            result.error = "Contact not found";
+        }
+        done.promise = std::move(batch[i].promise);
+        completed.push_back(std::move(done));
+    }
+
+    // The owner resolves the futures once it has applied the results
+    {
+        QMutexLocker locker(&m_mutex);
+        for (CompletedWrite &done : completed) {
+            m_completed.push_back(std::move(done));
+        }
+    }
+    emit resultsReady();
+}
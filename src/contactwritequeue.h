@@ -0,0 +1,114 @@
+#ifndef CONTACTWRITEQUEUE_H
+#define CONTACTWRITEQUEUE_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QMutex>
+#include <QObject>
+#include <QPromise>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <deque>
+#include "storageengine.h"
+
+/**
+ * @brief Outcome of one queued write, delivered once its batch committed
+ */
+struct WriteResult {
+    ContactWrite::Kind kind = ContactWrite::Insert;
+    Contact contact;      // as stored; carries the new id for inserts
+    Contact previous;     // the row before an update or remove
+    QString error;
+    qint64 latencyNs = 0; // from enqueue() until its batch committed
+
+    bool succeeded() const { return error.isEmpty(); }
+};
+
+/**
+ * @brief A committed write whose future has not been resolved yet
+ */
+struct CompletedWrite {
+    WriteResult result;
+    QPromise<WriteResult> promise;
+
+    // Finishes the future returned by ContactWriteQueue::enqueue()
+    void resolve()
+    {
+        promise.addResult(result);
+        promise.finish();
+    }
+};
+
+/**
+ * @brief Write-behind queue that group-commits contact mutations
+ *
+ * enqueue() returns immediately with a future. A writer thread collects
+ * queued writes and hands them to StorageEngine::applyWrites() as one
+ * transaction once maxBatchSize writes are waiting or the oldest one has
+ * waited maxLatencyMs, whichever comes first.
+ *
+ * Committed writes are kept, in submission order, for takeCompleted();
+ * resultsReady() is emitted from the writer thread after each batch. The
+ * futures are not resolved by the queue: the owner resolves each one
+ * after applying its result (cache, signals), so a finished future means
+ * the write is both durable and visible to the owner's readers. Writes
+ * still untaken when the queue is destroyed are resolved then.
+ */
+class ContactWriteQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxBatchSize = 1000;
+    static constexpr int DefaultMaxLatencyMs = 10;
+
+    explicit ContactWriteQueue(StorageEngine *engine, QObject *parent = nullptr);
+    // Commits whatever is still queued before returning
+    ~ContactWriteQueue();
+
+    void setMaxBatchSize(int writes);
+    int maxBatchSize() const;
+    void setMaxLatency(int milliseconds);
+    int maxLatency() const;
+
+    QFuture<WriteResult> enqueue(const ContactWrite &write);
+    // Blocks until every write enqueued so far is committed
+    void flush();
+    int pendingCount() const;
+
+    // Committed writes not yet taken, oldest first; call resolve() on each
+    std::deque<CompletedWrite> takeCompleted();
+
+signals:
+    void resultsReady();
+
+private:
+    struct PendingWrite {
+        ContactWrite write;
+        QPromise<WriteResult> promise;
+        qint64 enqueuedAt;     // ms, for the batching deadline
+        qint64 enqueuedNs;
+    };
+
+    StorageEngine *m_engine;
+    QThread *m_thread;
+    QElapsedTimer m_clock;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_queued;      // writer waits for work or a deadline
+    QWaitCondition m_committed;   // flush() waits for the writer
+    std::deque<PendingWrite> m_pending;
+    std::deque<CompletedWrite> m_completed;
+    int m_maxBatchSize;
+    int m_maxLatencyMs;
+    quint64 m_enqueued;
+    quint64 m_committedCount;
+    quint64 m_flushTarget;
+    bool m_stopping;
+
+    void run();
+    void commit(std::deque<PendingWrite> &batch);
+};
+
+#endif // CONTACTWRITEQUEUE_H
@@ -1,49 +1,177 @@
 #include "databasemanager.h"
-#include <QSqlQuery>
-#include <QSqlRecord>
-#include <QVariant>
+#include "sqlitestorageengine.h"
+#include "logging.h"
+#include <QElapsedTimer>
+#include <QPromise>
+#include <QSet>
 #include <QDebug>
+#include <memory>
+#include <utility>
 
+namespace {
+
+QFuture<WriteResult> failedWrite(ContactWrite::Kind kind, const Contact &contact,
+                                 const QString &error)
+{
+    WriteResult result;
+    result.kind = kind;
+    result.contact = contact;
+    result.error = error;
+
+    QPromise<WriteResult> promise;
+    promise.start();
+    promise.addResult(result);
+    promise.finish();
+    return promise.future();
+}
+
+QStringList operationNames()
+{
+    return {
+        "addContact", "addContacts", "updateContact", "deleteContact", "mergeContacts",
+        "deleteContacts", "updateContacts", "addContactAsync", "updateContactAsync",
+        "deleteContactAsync", "getContact", "getAllContacts", "searchContacts", "findByEmails",
+        "findByPhones", "getContactsPage", "getFacetCounts", "getContactsByFacet", "getChangesSince"
+    };
+}
+
+} // namespace
 
 DatabaseManager::DatabaseManager(QObject *parent)
     : QObject(parent)
+    , m_engine(new SqliteStorageEngine)
+    , m_openThread(nullptr)
+    , m_writeBatchSize(ContactWriteQueue::DefaultMaxBatchSize)
+    , m_writeLatencyMs(ContactWriteQueue::DefaultMaxLatencyMs)
+    , m_errorCount(0)
+    , m_metrics(operationNames())
 {
-    qDebug() << "Available SQL drivers:" << QSqlDatabase::drivers();
-    m_database = QSqlDatabase::addDatabase("QSQLITE");
+    Q_ASSERT(m_metrics.operations().size() == OperationCount);
 }
+
 DatabaseManager::~DatabaseManager()
 {
+    joinOpenThread();
     disconnectFromDatabase();
 }
+
+void DatabaseManager::setStorageEngine(std::unique_ptr<StorageEngine> engine)
+{
+    joinOpenThread();
+    disconnectFromDatabase();
+    m_engine = std::move(engine);
+    qCInfo(lcDatabase) << "Storage engine:" << m_engine->name();
+}
+
 bool DatabaseManager::connectToDatabase(const QString &host, const QString &database,
                                         const QString &user, const QString &password, int port)
 {
-    // For SQLite, we only need the database name (file path)
-    // The other parameters are ignored
-    m_database.setDatabaseName("contacts.db");
-
-    if (!m_database.open()) {
-        setLastError("Failed to connect: " + m_database.lastError().text());
+    // The engine knows its own location (file path or log);
+    // the server parameters are ignored
+    QString error;
+    if (!m_engine->open(&error)) {
+        setLastError(error);
         return false;
     }
 
-    qDebug() << "Successfully connected to SQLite database: contacts.db";
     emit databaseConnected();
     return true;
 }
 
+QFuture<bool> DatabaseManager::connectToDatabaseAsync()
+{
+    if (isConnected()) {
+        QPromise<bool> promise;
+        promise.start();
+        promise.addResult(true);
+        promise.finish();
+        return promise.future();
+    }
+
+    joinOpenThread();
+
+    // Carries the prepare() error, empty on success
+    auto prepared = std::make_shared<QPromise<QString>>();
+    prepared->start();
+    QFuture<QString> future = prepared->future();
+
+    StorageEngine *engine = m_engine.get();
+    m_openThread = QThread::create([engine, prepared]() {
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        if (!engine->prepare(&error) && error.isEmpty()) {
+            error = "Failed to prepare storage";
+        }
+        qCInfo(lcDatabase) << "Storage prepared off the GUI thread in" << timer.elapsed() << "ms";
+        prepared->addResult(error);
+        prepared->finish();
+    });
+    m_openThread->setObjectName("DatabaseOpen");
+    m_openThread->start();
+
+    return future.then(this, [this](const QString &prepareError) {
+        joinOpenThread();
+        if (!prepareError.isEmpty()) {
+            setLastError(prepareError);
+            return false;
+        }
+
+        // Both quick now: the file is migrated and indexed, or the log replayed
+        QString error;
+        if (!m_engine->open(&error) || !m_engine->createSchema(&error)) {
+            m_engine->close();
+            setLastError(error);
+            return false;
+        }
+
+        emit databaseConnected();
+        return true;
+    });
+}
+
+void DatabaseManager::joinOpenThread()
+{
+    if (!m_openThread) return;
+
+    m_openThread->wait();
+    delete m_openThread;
+    m_openThread = nullptr;
+}
+
 void DatabaseManager::disconnectFromDatabase()
 {
-    if (m_database.isOpen()) {
-        m_database.close();
+    if (isConnected()) {
+        stopWriteQueue();
+        m_cache.clear();
+        m_engine->close();
         emit databaseDisconnected();
-        qDebug() << "Database disconnected";
+        qCInfo(lcDatabase) << "Database disconnected";
     }
 }
 
 bool DatabaseManager::isConnected() const
 {
-    return m_database.isOpen();
+    return m_engine && m_engine->isOpen();
+}
+
+void DatabaseManager::setNativeReadsEnabled(bool enabled)
+{
+    if (auto *sqlite = dynamic_cast<SqliteStorageEngine *>(m_engine.get())) {
+        sqlite->setNativeReadsEnabled(enabled);
+    }
+}
+
+bool DatabaseManager::nativeReadsEnabled() const
+{
+    auto *sqlite = dynamic_cast<SqliteStorageEngine *>(m_engine.get());
+    return sqlite && sqlite->nativeReadsEnabled();
+}
+
+bool DatabaseManager::nativeReadsActive() const
+{
+    auto *sqlite = dynamic_cast<SqliteStorageEngine *>(m_engine.get());
+    return sqlite && sqlite->nativeReadsActive();
 }
 
 bool DatabaseManager::createTable()
@@ -53,30 +181,19 @@ bool DatabaseManager::createTable()
         return false;
     }
 
-    QSqlQuery query(m_database);
-    QString createTableSQL = R"(
-        CREATE TABLE IF NOT EXISTS contacts (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            first_name TEXT NOT NULL,
-            last_name TEXT NOT NULL,
-            email TEXT,
-            phone TEXT,
-            city TEXT,
-            country TEXT,
-            created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-
-    if (!query.exec(createTableSQL)) {
-        setLastError("Failed to create table: " + query.lastError().text());
+    QString error;
+    if (!m_engine->createSchema(&error)) {
+        setLastError(error);
         return false;
     }
-
-    qDebug() << "Table 'contacts' created or already exists";
     return true;
 }
+
 bool DatabaseManager::addContact(const Contact &contact)
 {
+    // Queued writes land first, outside this call's latency and error count
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(AddContactOp), &m_errorCount);
     if (!isConnected()) {
         setLastError("Database not connected");
         return false;
@@ -87,30 +204,51 @@ bool DatabaseManager::addContact(const Contact &contact)
         return false;
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO contacts (first_name, last_name, email, phone, city, country) "
-                 "VALUES (:firstName, :lastName, :email, :phone, :city, :country)");
-    
-    query.bindValue(":firstName", contact.firstName);
-    query.bindValue(":lastName", contact.lastName);
-    query.bindValue(":email", contact.email);
-    query.bindValue(":phone", contact.phone);
-    query.bindValue(":city", contact.city);
-    query.bindValue(":country", contact.country);
-
-    if (!query.exec()) {
-        setLastError("Failed to add contact: " + query.lastError().text());
+    Contact stored = contact;
+    QString error;
+    if (!m_engine->insert(&stored, &error)) {
+        setLastError(error);
         return false;
     }
 
-    int newId = query.lastInsertId().toInt();
-    emit contactAdded(newId);
-    qDebug() << "Contact added with ID:" << newId;
+    m_cache.insert(stored);
+    emit contactAdded(stored);
+    qCDebug(lcDatabase) << "Contact added with ID:" << stored.id;
     return true;
 }
 
+int DatabaseManager::addContacts(const QVector<Contact> &contacts)
+{
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(AddContactsOp), &m_errorCount);
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return -1;
+    }
+
+    QString error;
+    int inserted = m_engine->insertBatch(contacts, &error);
+    if (inserted < 0) {
+        setLastError(error);
+        return -1;
+    }
+
+    emit contactsImported(inserted);
+    qCDebug(lcDatabase) << "Bulk insert added" << inserted << "contacts";
+    return inserted;
+}
+
+void DatabaseManager::notifyContactsImported(int count)
+{
+    if (count > 0) {
+        emit contactsImported(count);
+    }
+}
+
 bool DatabaseManager::updateContact(const Contact &contact)
 {
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(UpdateContactOp), &m_errorCount);
     if (!isConnected()) {
         setLastError("Database not connected");
         return false;
@@ -121,31 +259,29 @@ bool DatabaseManager::updateContact(const Contact &contact)
         return false;
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE contacts SET first_name=:firstName, last_name=:lastName, "
-                 "email=:email, phone=:phone, city=:city, country=:country "
-                 "WHERE id=:id");
-    
-    query.bindValue(":id", contact.id);
-    query.bindValue(":firstName", contact.firstName);
-    query.bindValue(":lastName", contact.lastName);
-    query.bindValue(":email", contact.email);
-    query.bindValue(":phone", contact.phone);
-    query.bindValue(":city", contact.city);
-    query.bindValue(":country", contact.country);
-
-    if (!query.exec()) {
-        setLastError("Failed to update contact: " + query.lastError().text());
+    // The previous values tell listeners where the row used to sort
+    Contact previous;
+    if (!cachedContact(contact.id, &previous)) {
+        setLastError("Contact not found");
+        return false;
+    }
+
+    QString error;
+    if (!m_engine->update(contact, &error)) {
+        setLastError(error);
         return false;
     }
 
-    emit contactUpdated(contact.id);
-    qDebug() << "Contact updated, ID:" << contact.id;
+    m_cache.insert(contact);
+    emit contactUpdated(previous, contact);
+    qCDebug(lcDatabase) << "Contact updated, ID:" << contact.id;
     return true;
 }
 
 bool DatabaseManager::deleteContact(int id)
 {
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(DeleteContactOp), &m_errorCount);
     if (!isConnected()) {
         setLastError("Database not connected");
         return false;
@@ -156,125 +292,499 @@ bool DatabaseManager::deleteContact(int id)
         return false;
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM contacts WHERE id=:id");
-    query.bindValue(":id", id);
+    Contact previous;
+    if (!cachedContact(id, &previous)) {
+        setLastError("Contact not found");
+        return false;
+    }
 
-    if (!query.exec()) {
-        setLastError("Failed to delete contact: " + query.lastError().text());
+    QString error;
+    if (!m_engine->remove(id, &error)) {
+        setLastError(error);
         return false;
     }
 
-    emit contactDeleted(id);
-    qDebug() << "Contact deleted, ID:" << id;
+    m_cache.remove(id);
+    emit contactDeleted(previous);
+    qCDebug(lcDatabase) << "Contact deleted, ID:" << id;
     return true;
 }
 
-Contact DatabaseManager::getContact(int id)
+bool DatabaseManager::mergeContacts(const Contact &survivor, const QVector<int> &duplicateIds)
 {
-    Contact contact;
-    
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(MergeContactsOp), &m_errorCount);
     if (!isConnected()) {
         setLastError("Database not connected");
-        return contact;
+        return false;
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM contacts WHERE id=:id");
-    query.bindValue(":id", id);
+    if (survivor.id <= 0 || !survivor.isValid()) {
+        setLastError("Invalid contact data");
+        return false;
+    }
 
-    if (!query.exec() || !query.next()) {
+    Contact previous;
+    if (!cachedContact(survivor.id, &previous)) {
         setLastError("Contact not found");
+        return false;
+    }
+
+    // A repeated id is merged once, so each removal is signalled once
+    QSet<int> seen;
+    QVector<int> uniqueIds;
+    QVector<Contact> duplicates;
+    for (int id : duplicateIds) {
+        if (id == survivor.id) {
+            setLastError("A contact cannot be merged into itself");
+            return false;
+        }
+        if (seen.contains(id)) continue;
+        seen.insert(id);
+
+        Contact duplicate;
+        if (!cachedContact(id, &duplicate)) {
+            setLastError(QString("Contact %1 not found").arg(id));
+            return false;
+        }
+        uniqueIds.append(id);
+        duplicates.append(duplicate);
+    }
+
+    QString error;
+    if (!m_engine->merge(survivor, uniqueIds, &error)) {
+        setLastError(error);
+        return false;
+    }
+
+    m_cache.insert(survivor);
+    emit contactUpdated(previous, survivor);
+    for (const Contact &duplicate : duplicates) {
+        m_cache.remove(duplicate.id);
+        emit contactDeleted(duplicate);
+    }
+    qCDebug(lcDatabase) << "Merged" << duplicates.size() << "contacts into ID:" << survivor.id;
+    return true;
+}
+
+int DatabaseManager::deleteContacts(const QVector<int> &ids)
+{
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(DeleteContactsOp), &m_errorCount);
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return -1;
+    }
+
+    if (ids.isEmpty()) return 0;
+
+    QVector<Contact> removed;
+    QString error;
+    if (!m_engine->removeMany(ids, &removed, &error)) {
+        setLastError(error);
+        return -1;
+    }
+
+    for (const Contact &contact : std::as_const(removed)) {
+        m_cache.remove(contact.id);
+    }
+    if (!removed.isEmpty()) {
+        emit contactsDeleted(removed);
+    }
+    qCDebug(lcDatabase) << "Bulk delete removed" << removed.size() << "contacts";
+    return removed.size();
+}
+
+int DatabaseManager::updateContacts(const QVector<int> &ids, const ContactPatch &patch)
+{
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(UpdateContactsOp), &m_errorCount);
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return -1;
+    }
+
+    // Names are required, so a patch may change them but not clear them
+    if ((patch.firstName && patch.firstName->trimmed().isEmpty())
+        || (patch.lastName && patch.lastName->trimmed().isEmpty())) {
+        setLastError("Invalid contact data");
+        return -1;
+    }
+
+    if (ids.isEmpty() || patch.isEmpty()) return 0;
+
+    QVector<Contact> previous;
+    QString error;
+    if (!m_engine->updateMany(ids, patch, &previous, &error)) {
+        setLastError(error);
+        return -1;
+    }
+
+    QVector<Contact> current = previous;
+    for (Contact &contact : current) {
+        patch.applyTo(&contact);
+        m_cache.insert(contact);
+    }
+    if (!current.isEmpty()) {
+        emit contactsUpdated(previous, current);
+    }
+    qCDebug(lcDatabase) << "Bulk update changed" << current.size() << "contacts";
+    return current.size();
+}
+
+// ============= Write-behind queue =============
+
+QFuture<WriteResult> DatabaseManager::addContactAsync(const Contact &contact)
+{
+    if (!isConnected()) {
+        return failedWrite(ContactWrite::Insert, contact, "Database not connected");
+    }
+    if (!contact.isValid()) {
+        return failedWrite(ContactWrite::Insert, contact, "Invalid contact data");
+    }
+
+    ContactWrite write;
+    write.kind = ContactWrite::Insert;
+    write.contact = contact;
+    return enqueueWrite(write);
+}
+
+QFuture<WriteResult> DatabaseManager::updateContactAsync(const Contact &contact)
+{
+    if (!isConnected()) {
+        return failedWrite(ContactWrite::Update, contact, "Database not connected");
+    }
+    if (contact.id <= 0 || !contact.isValid()) {
+        return failedWrite(ContactWrite::Update, contact, "Invalid contact data");
+    }
+
+    ContactWrite write;
+    write.kind = ContactWrite::Update;
+    write.contact = contact;
+    return enqueueWrite(write);
+}
+
+QFuture<WriteResult> DatabaseManager::deleteContactAsync(int id)
+{
+    Contact contact;
+    contact.id = id;
+
+    if (!isConnected()) {
+        return failedWrite(ContactWrite::Remove, contact, "Database not connected");
+    }
+    if (id <= 0) {
+        return failedWrite(ContactWrite::Remove, contact, "Invalid contact ID");
+    }
+
+    ContactWrite write;
+    write.kind = ContactWrite::Remove;
+    write.contact = contact;
+    return enqueueWrite(write);
+}
+
+void DatabaseManager::setWriteBatching(int maxBatchSize, int maxLatencyMs)
+{
+    m_writeBatchSize = maxBatchSize;
+    m_writeLatencyMs = maxLatencyMs;
+    if (m_writeQueue) {
+        m_writeQueue->setMaxBatchSize(maxBatchSize);
+        m_writeQueue->setMaxLatency(maxLatencyMs);
+    }
+}
+
+void DatabaseManager::flushWrites()
+{
+    if (!m_writeQueue) return;
+
+    m_writeQueue->flush();
+    deliverWrites();
+}
+
+QFuture<WriteResult> DatabaseManager::enqueueWrite(const ContactWrite &write)
+{
+    // Started on first use, so a purely synchronous caller never pays for the thread
+    if (!m_writeQueue) {
+        m_writeQueue = std::make_unique<ContactWriteQueue>(m_engine.get());
+        m_writeQueue->setMaxBatchSize(m_writeBatchSize);
+        m_writeQueue->setMaxLatency(m_writeLatencyMs);
+        connect(m_writeQueue.get(), &ContactWriteQueue::resultsReady,
+                this, &DatabaseManager::deliverWrites, Qt::QueuedConnection);
+    }
+    return m_writeQueue->enqueue(write);
+}
+
+void DatabaseManager::deliverWrites()
+{
+    if (!m_writeQueue) return;
+
+    // Each future resolves only after its cache update and signal, so a
+    // continuation reads the written row
+    std::deque<CompletedWrite> completed = m_writeQueue->takeCompleted();
+    for (CompletedWrite &write : completed) {
+        const WriteResult &result = write.result;
+        const Operation operation = result.kind == ContactWrite::Insert ? AddContactAsyncOp
+                                    : result.kind == ContactWrite::Update ? UpdateContactAsyncOp
+                                                                          : DeleteContactAsyncOp;
+        m_metrics.histogram(operation).record(result.latencyNs, !result.succeeded());
+
+        if (!result.succeeded()) {
+            setLastError(result.error);
+            write.resolve();
+            continue;
+        }
+
+        switch (result.kind) {
+        case ContactWrite::Insert:
+            m_cache.insert(result.contact);
+            emit contactAdded(result.contact);
+            break;
+        case ContactWrite::Update:
+            m_cache.insert(result.contact);
+            emit contactUpdated(result.previous, result.contact);
+            break;
+        case ContactWrite::Remove:
+            m_cache.remove(result.previous.id);
+            emit contactDeleted(result.previous);
+            break;
+        }
+        write.resolve();
+    }
+}
+
+void DatabaseManager::stopWriteQueue()
+{
+    if (!m_writeQueue) return;
+
+    // Commit and signal everything still queued while the engine is open
+    flushWrites();
+    m_writeQueue.reset();
+}
+
+Contact DatabaseManager::getContact(int id)
+{
+    ScopedLatency latency(m_metrics.histogram(GetContactOp), &m_errorCount);
+    Contact contact;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
         return contact;
     }
 
-    contact.id = query.value("id").toInt();
-    contact.firstName = query.value("first_name").toString();
-    contact.lastName = query.value("last_name").toString();
-    contact.email = query.value("email").toString();
-    contact.phone = query.value("phone").toString();
-    contact.city = query.value("city").toString();
-    contact.country = query.value("country").toString();
+    if (!cachedContact(id, &contact)) {
+        setLastError("Contact not found");
+    }
 
     return contact;
 }
 
+bool DatabaseManager::cachedContact(int id, Contact *contact)
+{
+    if (m_cache.lookup(id, contact)) {
+        return true;
+    }
+
+    QString error;
+    if (!m_engine->get(id, contact, &error)) {
+        if (!error.isEmpty()) {
+            qCWarning(lcDatabase) << "DatabaseManager Error:" << error;
+        }
+        return false;
+    }
+
+    m_cache.insert(*contact);
+    return true;
+}
+
 QVector<Contact> DatabaseManager::getAllContacts()
 {
+    ScopedLatency latency(m_metrics.histogram(GetAllContactsOp), &m_errorCount);
     QVector<Contact> contacts;
-    
+
     if (!isConnected()) {
         setLastError("Database not connected");
         return contacts;
     }
 
-    QSqlQuery query(m_database);
-    if (!query.exec("SELECT * FROM contacts ORDER BY first_name, last_name")) {
-        setLastError("Failed to fetch contacts: " + query.lastError().text());
+    QString error;
+    if (!m_engine->getAll(&contacts, &error)) {
+        setLastError(error);
+    }
+
+    return contacts;
+}
+
+QVector<Contact> DatabaseManager::searchContacts(const QString &searchTerm, int limit)
+{
+    ScopedLatency latency(m_metrics.histogram(SearchContactsOp), &m_errorCount);
+    QVector<Contact> contacts;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
         return contacts;
     }
 
-    while (query.next()) {
-        Contact contact;
-        contact.id = query.value("id").toInt();
-        contact.firstName = query.value("first_name").toString();
-        contact.lastName = query.value("last_name").toString();
-        contact.email = query.value("email").toString();
-        contact.phone = query.value("phone").toString();
-        contact.city = query.value("city").toString();
-        contact.country = query.value("country").toString();
-        contacts.append(contact);
+    if (searchTerm.trimmed().isEmpty()) {
+        return getAllContacts();
+    }
+
+    QString error;
+    if (!m_engine->search(searchTerm, limit, &contacts, &error)) {
+        setLastError(error);
     }
 
     return contacts;
 }
 
-QVector<Contact> DatabaseManager::searchContacts(const QString &searchTerm)
+QVector<Contact> DatabaseManager::findByEmails(const QStringList &emails)
 {
+    ScopedLatency latency(m_metrics.histogram(FindByEmailsOp), &m_errorCount);
     QVector<Contact> contacts;
-    
+
     if (!isConnected()) {
         setLastError("Database not connected");
         return contacts;
     }
 
-    if (searchTerm.isEmpty()) {
-        return getAllContacts();
+    QString error;
+    if (!m_engine->findByEmail(emails, &contacts, &error)) {
+        setLastError(error);
+    }
+
+    return contacts;
+}
+
+QVector<Contact> DatabaseManager::findByPhones(const QStringList &phones)
+{
+    ScopedLatency latency(m_metrics.histogram(FindByPhonesOp), &m_errorCount);
+    QVector<Contact> contacts;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return contacts;
+    }
+
+    QString error;
+    if (!m_engine->findByPhone(phones, &contacts, &error)) {
+        setLastError(error);
+    }
+
+    return contacts;
+}
+
+QVector<Contact> DatabaseManager::getContactsPage(const Contact &after, int limit)
+{
+    ScopedLatency latency(m_metrics.histogram(GetContactsPageOp), &m_errorCount);
+    QVector<Contact> contacts;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return contacts;
+    }
+
+    QString error;
+    if (!m_engine->page(after, limit, &contacts, &error)) {
+        setLastError(error);
     }
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM contacts WHERE "
-                 "first_name LIKE :term OR last_name LIKE :term OR "
-                 "email LIKE :term OR phone LIKE :term OR "
-                 "city LIKE :term OR country LIKE :term "
-                 "ORDER BY first_name, last_name");
-    
-    QString likePattern = "%" + searchTerm + "%";
-    query.bindValue(":term", likePattern);
+    return contacts;
+}
+
+QVector<FacetCount> DatabaseManager::getFacetCounts(ContactFacet facet)
+{
+    ScopedLatency latency(m_metrics.histogram(GetFacetCountsOp), &m_errorCount);
+    QVector<FacetCount> counts;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return counts;
+    }
 
-    if (!query.exec()) {
-        setLastError("Failed to search contacts: " + query.lastError().text());
+    QString error;
+    if (!m_engine->facetCounts(facet, &counts, &error)) {
+        setLastError(error);
+    }
+
+    return counts;
+}
+
+QVector<Contact> DatabaseManager::getContactsByFacet(ContactFacet facet, const QString &value,
+                                                     int limit)
+{
+    ScopedLatency latency(m_metrics.histogram(GetContactsByFacetOp), &m_errorCount);
+    QVector<Contact> contacts;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
         return contacts;
     }
 
-    while (query.next()) {
-        Contact contact;
-        contact.id = query.value("id").toInt();
-        contact.firstName = query.value("first_name").toString();
-        contact.lastName = query.value("last_name").toString();
-        contact.email = query.value("email").toString();
-        contact.phone = query.value("phone").toString();
-        contact.city = query.value("city").toString();
-        contact.country = query.value("country").toString();
-        contacts.append(contact);
+    QString error;
+    if (!m_engine->findByFacet(facet, value, limit, &contacts, &error)) {
+        setLastError(error);
     }
 
     return contacts;
 }
 
+QVector<ContactChange> DatabaseManager::getChangesSince(qint64 sequence, int limit)
+{
+    // Queued writes are not in the log until they commit
+    flushWrites();
+    ScopedLatency latency(m_metrics.histogram(GetChangesSinceOp), &m_errorCount);
+    QVector<ContactChange> changes;
+
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return changes;
+    }
+
+    QString error;
+    if (!m_engine->changesSince(sequence, limit, &changes, &error)) {
+        setLastError(error);
+    }
+
+    return changes;
+}
+
+int DatabaseManager::compactChangeLog(qint64 sequence)
+{
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return -1;
+    }
+
+    QString error;
+    int removed = m_engine->compactChanges(sequence, &error);
+    if (removed < 0) {
+        setLastError(error);
+        return -1;
+    }
+
+    qCInfo(lcDatabase) << "Change log compacted up to" << sequence << ":" << removed << "changes removed";
+    return removed;
+}
+
+bool DatabaseManager::compactStorage()
+{
+    if (!isConnected()) {
+        setLastError("Database not connected");
+        return false;
+    }
+
+    flushWrites();
+
+    QString error;
+    if (!m_engine->compact(&error)) {
+        setLastError(error);
+        return false;
+    }
+    return true;
+}
+
 void DatabaseManager::setLastError(const QString &error)
 {
     m_lastError = error;
+    m_errorCount.fetch_add(1, std::memory_order_relaxed);
     emit errorOccurred(error);
-    qWarning() << "DatabaseManager Error:" << error;
+    qCWarning(lcDatabase) << "DatabaseManager Error:" << error;
 }
@@ -1,11 +1,17 @@
 #ifndef DATABASEMANAGER_H
 #define DATABASEMANAGER_H
 
+#include <QFuture>
 #include <QObject>
-#include <QSqlDatabase>
-#include <QSqlError>
+#include <QThread>
 #include <QVector>
+#include <atomic>
+#include <memory>
 #include "contact.h"
+#include "contactcache.h"
+#include "contactwritequeue.h"
+#include "operationmetrics.h"
+#include "storageengine.h"
 
 
 class DatabaseManager : public QObject
@@ -13,38 +19,177 @@ class DatabaseManager : public QObject
     Q_OBJECT
 
 public:
+    // Operations with a latency histogram in metrics(); the async ones
+    // measure from enqueue to commit
+    enum Operation {
+        AddContactOp,
+        AddContactsOp,
+        UpdateContactOp,
+        DeleteContactOp,
+        MergeContactsOp,
+        DeleteContactsOp,
+        UpdateContactsOp,
+        AddContactAsyncOp,
+        UpdateContactAsyncOp,
+        DeleteContactAsyncOp,
+        GetContactOp,
+        GetAllContactsOp,
+        SearchContactsOp,
+        FindByEmailsOp,
+        FindByPhonesOp,
+        GetContactsPageOp,
+        GetFacetCountsOp,
+        GetContactsByFacetOp,
+        GetChangesSinceOp,
+        OperationCount
+    };
+
+    // Uses a SqliteStorageEngine on contacts.db unless another engine is set
     explicit DatabaseManager(QObject *parent = nullptr);
     ~DatabaseManager();
 
+    // Replaces the storage backend; disconnects from the current one first
+    void setStorageEngine(std::unique_ptr<StorageEngine> engine);
+    // Thread-safe once connected, for worker threads
+    StorageEngine *storageEngine() const { return m_engine.get(); }
+
     // Database connection
     bool connectToDatabase(const QString &host, const QString &database,
                           const QString &user, const QString &password,
                           int port = 3306);
+    // Same, but the slow part (schema upgrades, index builds, log replay)
+    // runs on a worker thread; the future resolves on this thread once
+    // the engine is open and its schema checked, right after
+    // databaseConnected(). The server parameters are not needed.
+    QFuture<bool> connectToDatabaseAsync();
     void disconnectFromDatabase();
     bool isConnected() const;
     QString lastError() const { return m_lastError; }
 
+    // Reads through the sqlite3 C API when built with it (see
+    // CONTACTMANAGER_NATIVE_SQLITE; enabled whenever available).
+    // Only meaningful for the SQLite engine.
+    void setNativeReadsEnabled(bool enabled);
+    bool nativeReadsEnabled() const;
+    bool nativeReadsActive() const;
+
+    // Write-through id -> Contact cache in front of getContact(), filled
+    // by its misses and by writes; bulk reads bypass it
+    void setContactCacheBudget(qint64 budgetBytes) { m_cache.setBudget(budgetBytes); }
+    ContactCacheStats contactCacheStats() const { return m_cache.stats(); }
+    void resetContactCacheStats() { m_cache.resetStats(); }
+
+    // Latency, call count and error count of every CRUD method; an error
+    // is any call that set lastError(). Search, page and single-contact
+    // reads made by the searcher and HTTP workers are counted too.
+    const OperationMetrics &metrics() const { return m_metrics; }
+    void resetMetrics() { m_metrics.reset(); }
+    // Recording is lock-free, so threads that read through storageEngine()
+    // directly time their calls here under the matching operation
+    LatencyHistogram &histogram(Operation operation) { return m_metrics.histogram(operation); }
+
     // CRUD Operations
     bool createTable();
     bool addContact(const Contact &contact);
+    // Inserts in a single transaction and emits one contactsImported().
+    // Invalid contacts are skipped; returns the number inserted or -1.
+    int addContacts(const QVector<Contact> &contacts);
+    // For bulk loaders that insert through storageEngine() directly, such
+    // as ContactImporter: emits contactsImported() so views and facet
+    // counts catch up. Does nothing for count <= 0.
+    void notifyContactsImported(int count);
     bool updateContact(const Contact &contact);
     bool deleteContact(int id);
+    // Stores 'survivor' (an existing contact) and deletes the duplicates in
+    // one atomic step. Emits contactUpdated() for the survivor, then
+    // contactDeleted() for each duplicate.
+    bool mergeContacts(const Contact &survivor, const QVector<int> &duplicateIds);
+    // Set-based bulk changes: one statement in one transaction, followed by
+    // a single contactsDeleted() / contactsUpdated(). Unknown ids are
+    // ignored. Return the number of contacts affected, or -1.
+    int deleteContacts(const QVector<int> &ids);
+    int updateContacts(const QVector<int> &ids, const ContactPatch &patch);
+
+    // Write-behind variants: queued and group-committed on a writer thread.
+    // The future resolves on this thread once the write is committed and
+    // its mutation signal (in submission order) has been emitted, so reads
+    // see the write as soon as its future has finished. The synchronous
+    // mutators flush the queue first, so the two can be mixed.
+    QFuture<WriteResult> addContactAsync(const Contact &contact);
+    QFuture<WriteResult> updateContactAsync(const Contact &contact);
+    QFuture<WriteResult> deleteContactAsync(int id);
+    // Commit after this many queued writes or once the oldest has waited
+    // this long, whichever comes first
+    void setWriteBatching(int maxBatchSize, int maxLatencyMs);
+    // Blocks until every queued write is committed and signalled
+    void flushWrites();
     Contact getContact(int id);
     QVector<Contact> getAllContacts();
-    QVector<Contact> searchContacts(const QString &searchTerm);
+    // Ranked search; prefix matches every whitespace-separated token.
+    // A negative limit returns all matches.
+    QVector<Contact> searchContacts(const QString &searchTerm, int limit = -1);
+    // Exact, index-backed lookups on the normalized email or phone
+    // ("+1 (555) 010-2000" matches "5550102000"). The batch forms answer
+    // many keys in one call.
+    QVector<Contact> findByEmail(const QString &email) { return findByEmails({email}); }
+    QVector<Contact> findByEmails(const QStringList &emails);
+    QVector<Contact> findByPhone(const QString &phone) { return findByPhones({phone}); }
+    QVector<Contact> findByPhones(const QStringList &phones);
+
+    // Keyset pagination over the default sort order (first_name, last_name, id).
+    // Pass a default-constructed Contact as 'after' to start from the first row.
+    QVector<Contact> getContactsPage(const Contact &after, int limit);
+
+    // Contacts per country or city, largest first, from counts the engine
+    // maintains on every write
+    QVector<FacetCount> getFacetCounts(ContactFacet facet);
+    // Contacts with the given country or city ("" for none), in sort order
+    QVector<Contact> getContactsByFacet(ContactFacet facet, const QString &value, int limit = -1);
+
+    // Change log for mirroring into other systems. Pass 0 to start from
+    // the beginning, then the sequence of the last change received; a page
+    // shorter than 'limit' means the consumer has caught up.
+    QVector<ContactChange> getChangesSince(qint64 sequence, int limit = 1000);
+    // Collapses the log up to 'sequence' to the newest change per contact.
+    // Returns the number of changes removed, or -1.
+    int compactChangeLog(qint64 sequence);
+
+    // Reclaims space in the underlying storage (VACUUM for SQLite, a log
+    // rewrite for the memory engine). Blocks until done.
+    bool compactStorage();
 
 signals:
     void databaseConnected();
     void databaseDisconnected();
-    void contactAdded(int id);
-    void contactUpdated(int id);
-    void contactDeleted(int id);
+    // Mutation signals carry the row so views can update in place
+    void contactAdded(const Contact &contact);
+    void contactUpdated(const Contact &previous, const Contact &current);
+    void contactDeleted(const Contact &contact);
+    void contactsImported(int count);
+    // Bulk changes, rows in sort order; previous and current line up by index
+    void contactsDeleted(const QVector<Contact> &contacts);
+    void contactsUpdated(const QVector<Contact> &previous, const QVector<Contact> &current);
     void errorOccurred(const QString &error);
 
+private slots:
+    void deliverWrites();
+
 private:
-    QSqlDatabase m_database;
+    std::unique_ptr<StorageEngine> m_engine;
+    std::unique_ptr<ContactWriteQueue> m_writeQueue;
+    QThread *m_openThread;
+    int m_writeBatchSize;
+    int m_writeLatencyMs;
     QString m_lastError;
-    
+    std::atomic<quint64> m_errorCount;
+    ContactCache m_cache;
+    OperationMetrics m_metrics;
+
+    QFuture<WriteResult> enqueueWrite(const ContactWrite &write);
+    void stopWriteQueue();
+    void joinOpenThread();
+
+    bool cachedContact(int id, Contact *contact);
     void setLastError(const QString &error);
 };
 
@@ -0,0 +1,132 @@
+#include "diagnosticspanel.h"
+#include "databasemanager.h"
+#include "networkmanager.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+DiagnosticsPanel::DiagnosticsPanel(DatabaseManager *dbManager, NetworkManager *networkManager,
+                                   QWidget *parent)
+    : QDockWidget("Diagnostics", parent)
+    , m_dbManager(dbManager)
+    , m_networkManager(networkManager)
+    , m_refreshTimer(new QTimer(this))
+{
+    setObjectName("diagnosticsPanel");
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({"Operation", "Calls", "Errors", "p50", "p99", "Max"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QPushButton *resetButton = new QPushButton("Reset", this);
+    QPushButton *saveButton = new QPushButton("Save JSON...", this);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsPanel::onResetClicked);
+    connect(saveButton, &QPushButton::clicked, this, &DiagnosticsPanel::onSaveClicked);
+
+    QWidget *contents = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(contents);
+    layout->addWidget(m_table);
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget(resetButton);
+    buttons->addWidget(saveButton);
+    layout->addLayout(buttons);
+    setWidget(contents);
+
+    // Only tick while someone is looking
+    m_refreshTimer->setInterval(RefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::refresh);
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) {
+            refresh();
+            m_refreshTimer->start();
+        } else {
+            m_refreshTimer->stop();
+        }
+    });
+}
+
+QJsonObject DiagnosticsPanel::toJson() const
+{
+    QJsonObject report;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    report["database"] = m_dbManager->metrics().toJson();
+    report["network"] = m_networkManager->metrics().toJson();
+    return report;
+}
+
+void DiagnosticsPanel::refresh()
+{
+    m_table->setUpdatesEnabled(false);
+    m_table->setRowCount(0);
+    int row = addRows(0, "database", m_dbManager->metrics());
+    addRows(row, "network", m_networkManager->metrics());
+    m_table->setUpdatesEnabled(true);
+}
+
+int DiagnosticsPanel::addRows(int row, const QString &prefix, const OperationMetrics &metrics)
+{
+    const QVector<LatencySummary> summaries = metrics.summaries();
+    m_table->setRowCount(row + summaries.size());
+
+    for (const LatencySummary &summary : summaries) {
+        const QString errors = summary.errors == 0
+            ? QString("0")
+            : QString("%1 (%2%)").arg(summary.errors).arg(summary.errorRate() * 100, 0, 'f', 1);
+
+        m_table->setItem(row, OperationColumn, new QTableWidgetItem(prefix + "." + summary.operation));
+        m_table->setItem(row, CountColumn, new QTableWidgetItem(QString::number(summary.count)));
+        m_table->setItem(row, ErrorRateColumn, new QTableWidgetItem(errors));
+        m_table->setItem(row, P50Column, new QTableWidgetItem(formatLatency(summary.p50Ns)));
+        m_table->setItem(row, P99Column, new QTableWidgetItem(formatLatency(summary.p99Ns)));
+        m_table->setItem(row, MaxColumn, new QTableWidgetItem(formatLatency(summary.maxNs)));
+        for (int column = CountColumn; column < ColumnCount; ++column) {
+            m_table->item(row, column)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        ++row;
+    }
+    return row;
+}
+
+void DiagnosticsPanel::onResetClicked()
+{
+    m_dbManager->resetMetrics();
+    m_networkManager->resetMetrics();
+    refresh();
+}
+
+void DiagnosticsPanel::onSaveClicked()
+{
+    const QString filePath = QFileDialog::getSaveFileName(this, "Save Diagnostics", "diagnostics.json",
+                                                          "JSON files (*.json)");
+    if (filePath.isEmpty()) return;
+
+    QFile file(filePath);
+    const QByteArray json = QJsonDocument(toJson()).toJson();
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        QMessageBox::warning(this, "Save Failed",
+                             "Cannot write " + filePath + ": " + file.errorString());
+    }
+}
+
+QString DiagnosticsPanel::formatLatency(qint64 nanoseconds)
+{
+    if (nanoseconds < 1000000) {
+        return QString("%1 µs").arg(nanoseconds / 1e3, 0, 'f', 1);
+    }
+    if (nanoseconds < 1000000000) {
+        return QString("%1 ms").arg(nanoseconds / 1e6, 0, 'f', 1);
+    }
+    return QString("%1 s").arg(nanoseconds / 1e9, 0, 'f', 2);
+}
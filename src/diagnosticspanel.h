@@ -0,0 +1,60 @@
+#ifndef DIAGNOSTICSPANEL_H
+#define DIAGNOSTICSPANEL_H
+
+#include <QDockWidget>
+#include <QJsonObject>
+
+class DatabaseManager;
+class NetworkManager;
+class OperationMetrics;
+class QTableWidget;
+class QTimer;
+
+/**
+ * @brief Dock showing per-operation latency of the database and network
+ *
+ * Lists count, error rate and p50/p99/max latency for every operation
+ * that has been called, refreshed once a second while visible. The same
+ * numbers can be reset or saved as JSON.
+ */
+class DiagnosticsPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int RefreshIntervalMs = 1000;
+
+    DiagnosticsPanel(DatabaseManager *dbManager, NetworkManager *networkManager,
+                     QWidget *parent = nullptr);
+
+    // {"timestamp", "database": [...], "network": [...]}
+    QJsonObject toJson() const;
+
+public slots:
+    void refresh();
+
+private slots:
+    void onResetClicked();
+    void onSaveClicked();
+
+private:
+    enum Column {
+        OperationColumn,
+        CountColumn,
+        ErrorRateColumn,
+        P50Column,
+        P99Column,
+        MaxColumn,
+        ColumnCount
+    };
+
+    DatabaseManager *m_dbManager;
+    NetworkManager *m_networkManager;
+    QTableWidget *m_table;
+    QTimer *m_refreshTimer;
+
+    int addRows(int row, const QString &prefix, const OperationMetrics &metrics);
+    static QString formatLatency(qint64 nanoseconds);
+};
+
+#endif // DIAGNOSTICSPANEL_H
@@ -0,0 +1,335 @@
+#include "duplicatefinder.h"
+#include "contactnormalizer.h"
+#include "databasemanager.h"
+#include <QHash>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Below this many items per thread, spawning threads costs more than it saves
+constexpr int MinItemsPerThread = 2048;
+// How often long loops look at the cancellation flag
+constexpr int CancelCheckInterval = 4096;
+
+struct NormalizedContact {
+    QString name;         // "first last", folded
+    QString swappedName;  // "last first", for transposed fields
+    QString first;
+    QString last;
+    QString email;
+    QString phone;
+    QString city;
+};
+
+// Splits [0, count) into contiguous ranges, one per thread
+void parallelFor(int count, int threads, const std::function<void(int, int)> &body)
+{
+    threads = qBound(1, threads, qMax(1, count / MinItemsPerThread));
+    if (threads == 1) {
+        body(0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    const int chunk = (count + threads - 1) / threads;
+    for (int begin = 0; begin < count; begin += chunk) {
+        workers.emplace_back(body, begin, qMin(count, begin + chunk));
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+NormalizedContact normalize(const Contact &contact, const QString &defaultCountryCode)
+{
+    NormalizedContact normalized;
+    normalized.first = ContactNormalizer::name(contact.firstName);
+    normalized.last = ContactNormalizer::name(contact.lastName);
+    normalized.name = normalized.first + ' ' + normalized.last;
+    normalized.swappedName = normalized.last + ' ' + normalized.first;
+    normalized.email = ContactNormalizer::email(contact.email);
+    normalized.phone = ContactNormalizer::phone(contact.phone, defaultCountryCode);
+    normalized.city = ContactNormalizer::name(contact.city);
+    return normalized;
+}
+
+QStringList blockingKeys(const NormalizedContact &contact)
+{
+    QStringList keys;
+    if (!contact.email.isEmpty()) keys.append("e:" + contact.email);
+    if (!contact.phone.isEmpty()) keys.append("p:" + contact.phone);
+
+    // Order-insensitive, so "Smith John" meets "John Smith"
+    QStringList nameTokens = contact.name.split(' ', Qt::SkipEmptyParts);
+    std::sort(nameTokens.begin(), nameTokens.end());
+    if (!nameTokens.isEmpty()) keys.append("n:" + nameTokens.join(' '));
+
+    // Survives typos and nicknames in the first name
+    if (!contact.last.isEmpty() && !contact.first.isEmpty()) {
+        keys.append("i:" + contact.last + '|' + contact.first.at(0));
+    }
+    return keys;
+}
+
+double nameScore(const NormalizedContact &a, const NormalizedContact &b)
+{
+    return qMax(DuplicateFinder::nameSimilarity(a.name, b.name),
+                DuplicateFinder::nameSimilarity(a.swappedName, b.name));
+}
+
+double score(const NormalizedContact &a, const NormalizedContact &b)
+{
+    double total = 0.55 * nameScore(a, b);
+    if (!a.email.isEmpty() && a.email == b.email) total += 0.45;
+    if (!a.phone.isEmpty() && a.phone == b.phone) total += 0.35;
+    if (!a.city.isEmpty() && a.city == b.city) total += 0.05;
+    return qMin(1.0, total);
+}
+
+QStringList reasons(const NormalizedContact &a, const NormalizedContact &b)
+{
+    QStringList result;
+    if (!a.email.isEmpty() && a.email == b.email) result.append("same email");
+    if (!a.phone.isEmpty() && a.phone == b.phone) result.append("same phone");
+    double name = nameScore(a, b);
+    if (name >= 0.999) {
+        result.append("same name");
+    } else if (name >= 0.85) {
+        result.append(QString("similar name (%1%)").arg(qRound(name * 100)));
+    }
+    if (!a.city.isEmpty() && a.city == b.city) result.append("same city");
+    return result;
+}
+
+} // namespace
+
+// ============= DuplicateFinder =============
+
+double DuplicateFinder::nameSimilarity(const QString &a, const QString &b)
+{
+    if (a == b) return 1.0;
+    const int lengthA = a.size();
+    const int lengthB = b.size();
+    if (lengthA == 0 || lengthB == 0) return 0.0;
+
+    const int window = qMax(0, qMax(lengthA, lengthB) / 2 - 1);
+    std::vector<bool> matchedA(lengthA, false);
+    std::vector<bool> matchedB(lengthB, false);
+
+    int matches = 0;
+    for (int i = 0; i < lengthA; ++i) {
+        const int from = qMax(0, i - window);
+        const int to = qMin(lengthB - 1, i + window);
+        for (int j = from; j <= to; ++j) {
+            if (matchedB[j] || a.at(i) != b.at(j)) continue;
+            matchedA[i] = matchedB[j] = true;
+            ++matches;
+            break;
+        }
+    }
+    if (matches == 0) return 0.0;
+
+    int transpositions = 0;
+    for (int i = 0, j = 0; i < lengthA; ++i) {
+        if (!matchedA[i]) continue;
+        while (!matchedB[j]) ++j;
+        if (a.at(i) != b.at(j)) ++transpositions;
+        ++j;
+    }
+
+    const double m = matches;
+    const double jaro = (m / lengthA + m / lengthB + (m - transpositions / 2.0) / m) / 3.0;
+
+    // Winkler boost for a shared prefix of up to four characters
+    int prefix = 0;
+    while (prefix < qMin(4, qMin(lengthA, lengthB)) && a.at(prefix) == b.at(prefix)) ++prefix;
+    return jaro + prefix * 0.1 * (1.0 - jaro);
+}
+
+QVector<DuplicateMatch> DuplicateFinder::find(const QVector<Contact> &contacts,
+                                              const DuplicateOptions &options,
+                                              const std::function<bool()> &isCancelled)
+{
+    QVector<DuplicateMatch> matches;
+    const int count = contacts.size();
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    auto cancelled = [&isCancelled]() { return isCancelled && isCancelled(); };
+
+    // Normalizing is the expensive part of blocking, so it runs in parallel too
+    std::vector<NormalizedContact> normalized(count);
+    parallelFor(count, threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            normalized[i] = normalize(contacts.at(i), options.defaultCountryCode);
+        }
+    });
+    if (cancelled()) return matches;
+
+    QHash<QString, QVector<int>> blocks;
+    for (int i = 0; i < count; ++i) {
+        for (const QString &key : blockingKeys(normalized[i])) {
+            blocks[key].append(i);
+        }
+    }
+
+    // A pair can share several keys; it is scored once
+    QSet<quint64> seen;
+    std::vector<std::pair<int, int>> pairs;
+    int skippedBlocks = 0;
+    for (auto it = blocks.cbegin(); it != blocks.cend(); ++it) {
+        const QVector<int> &members = it.value();
+        if (members.size() < 2) continue;
+        if (members.size() > options.maxBlockSize) {
+            ++skippedBlocks;
+            continue;
+        }
+
+        for (int i = 0; i < members.size(); ++i) {
+            for (int j = i + 1; j < members.size(); ++j) {
+                const quint64 key = (quint64(quint32(members[i])) << 32) | quint32(members[j]);
+                if (!seen.contains(key)) {
+                    seen.insert(key);
+                    pairs.emplace_back(members[i], members[j]);
+                }
+            }
+        }
+        if (cancelled()) return matches;
+    }
+    blocks.clear();
+    seen.clear();
+
+    qDebug() << "Duplicate scan:" << count << "contacts," << pairs.size() << "candidate pairs,"
+             << skippedBlocks << "oversized blocks skipped";
+
+    std::vector<double> scores(pairs.size());
+    std::atomic<bool> stop(false);
+    parallelFor(int(pairs.size()), threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            if ((i - begin) % CancelCheckInterval == 0 && (stop || cancelled())) {
+                stop = true;
+                return;
+            }
+            scores[i] = score(normalized[pairs[i].first], normalized[pairs[i].second]);
+        }
+    });
+    if (stop) return matches;
+
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (scores[i] < options.threshold) continue;
+
+        const int a = pairs[i].first;
+        const int b = pairs[i].second;
+        const bool aFirst = contacts.at(a).id < contacts.at(b).id;
+
+        DuplicateMatch match;
+        match.first = contacts.at(aFirst ? a : b);
+        match.second = contacts.at(aFirst ? b : a);
+        match.score = scores[i];
+        match.reasons = reasons(normalized[a], normalized[b]);
+        matches.append(match);
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const DuplicateMatch &x, const DuplicateMatch &y) {
+        if (x.score != y.score) return x.score > y.score;
+        return x.first.id < y.first.id;
+    });
+    return matches;
+}
+
+Contact DuplicateFinder::merged(const Contact &keep, const Contact &other)
+{
+    Contact result = keep;
+    for (auto field : {&Contact::firstName, &Contact::lastName, &Contact::email,
+                       &Contact::phone, &Contact::city, &Contact::country}) {
+        if ((result.*field).trimmed().isEmpty()) {
+            result.*field = other.*field;
+        }
+    }
+    return result;
+}
+
+// ============= DuplicateScanWorker =============
+
+DuplicateScanWorker::DuplicateScanWorker(DatabaseManager *dbManager,
+                                         const std::atomic<bool> *cancelled)
+    : m_dbManager(dbManager)
+    , m_cancelled(cancelled)
+{
+}
+
+void DuplicateScanWorker::scan(const DuplicateOptions &options)
+{
+    emit statusChanged("Loading contacts...");
+
+    QVector<Contact> contacts;
+    QString error;
+    if (!m_dbManager->storageEngine()->getAll(&contacts, &error)) {
+        emit finished(QVector<DuplicateMatch>(), error);
+        return;
+    }
+
+    emit statusChanged(QString("Comparing %1 contacts...").arg(contacts.size()));
+
+    QVector<DuplicateMatch> matches = DuplicateFinder::find(
+        contacts, options, [this]() { return m_cancelled->load(std::memory_order_relaxed); });
+
+    emit finished(matches, QString());
+}
+
+// ============= DuplicateScanner =============
+
+DuplicateScanner::DuplicateScanner(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(dbManager)
+    , m_running(false)
+    , m_cancelled(false)
+{
+    qRegisterMetaType<DuplicateOptions>("DuplicateOptions");
+    qRegisterMetaType<QVector<DuplicateMatch>>("QVector<DuplicateMatch>");
+
+    auto *worker = new DuplicateScanWorker(m_dbManager, &m_cancelled);
+    worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &DuplicateScanner::workerScanRequested,
+            worker, &DuplicateScanWorker::scan);
+    connect(worker, &DuplicateScanWorker::statusChanged,
+            this, &DuplicateScanner::statusChanged);
+    connect(worker, &DuplicateScanWorker::finished,
+            this, &DuplicateScanner::onWorkerFinished);
+
+    m_thread.setObjectName("DuplicateScanner");
+    m_thread.start();
+}
+
+DuplicateScanner::~DuplicateScanner()
+{
+    cancel();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool DuplicateScanner::start(const DuplicateOptions &options)
+{
+    if (m_running || !m_dbManager->isConnected()) return false;
+
+    m_running = true;
+    m_cancelled = false;
+    emit workerScanRequested(options);
+    return true;
+}
+
+void DuplicateScanner::cancel()
+{
+    m_cancelled = true;
+}
+
+void DuplicateScanner::onWorkerFinished(const QVector<DuplicateMatch> &matches, const QString &error)
+{
+    m_running = false;
+    emit finished(matches, error);
+}
@@ -0,0 +1,119 @@
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "contact.h"
+
+class DatabaseManager;
+
+/**
+ * @brief A pair of contacts that probably describe the same person
+ */
+struct DuplicateMatch {
+    Contact first;    // lower id; the suggested survivor
+    Contact second;
+    double score = 0;
+    QStringList reasons;
+};
+
+struct DuplicateOptions {
+    // Pairs scoring below this are not reported
+    double threshold = 0.6;
+    // Blocks larger than this (e.g. everyone named "J Smith") are too
+    // common to say anything and would make the pass quadratic again
+    int maxBlockSize = 500;
+    // Scoring threads; 0 uses every core
+    int threads = 0;
+    QString defaultCountryCode = QStringLiteral("1");
+};
+
+/**
+ * @brief Candidate generation and scoring for duplicate contacts
+ *
+ * Comparing every pair is quadratic, so contacts are first grouped into
+ * blocks that share a key: normalized email, normalized phone, the set
+ * of name tokens, or last name plus first initial. Only pairs that meet
+ * in some block are scored, which keeps the work close to linear in the
+ * number of contacts. Scoring runs on a pool of std::threads and combines
+ * exact email/phone agreement with Jaro-Winkler similarity of the names.
+ */
+class DuplicateFinder
+{
+public:
+    // Best matches first. A cancelled run returns no matches.
+    static QVector<DuplicateMatch> find(const QVector<Contact> &contacts,
+                                        const DuplicateOptions &options = DuplicateOptions(),
+                                        const std::function<bool()> &isCancelled = {});
+
+    // 'keep' with its empty fields filled in from 'other'
+    static Contact merged(const Contact &keep, const Contact &other);
+
+    // Jaro-Winkler similarity in [0, 1]
+    static double nameSimilarity(const QString &a, const QString &b);
+};
+
+/**
+ * @brief Runs DuplicateFinder over the whole store on a worker thread
+ */
+class DuplicateScanWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    DuplicateScanWorker(DatabaseManager *dbManager, const std::atomic<bool> *cancelled);
+
+public slots:
+    void scan(const DuplicateOptions &options);
+
+signals:
+    void statusChanged(const QString &message);
+    void finished(const QVector<DuplicateMatch> &matches, const QString &error);
+
+private:
+    DatabaseManager *m_dbManager;
+    const std::atomic<bool> *m_cancelled;
+};
+
+/**
+ * @brief Background duplicate scan with cancellation
+ *
+ * Reads every contact through the storage engine on its own thread, so
+ * the GUI stays responsive; finished() is emitted once per start().
+ */
+class DuplicateScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicateScanner(DatabaseManager *dbManager, QObject *parent = nullptr);
+    ~DuplicateScanner();
+
+    bool isRunning() const { return m_running; }
+
+public slots:
+    bool start(const DuplicateOptions &options = DuplicateOptions());
+    void cancel();
+
+signals:
+    void statusChanged(const QString &message);
+    void finished(const QVector<DuplicateMatch> &matches, const QString &error);
+
+    // Internal: hands the scan over to the worker thread
+    void workerScanRequested(const DuplicateOptions &options);
+
+private slots:
+    void onWorkerFinished(const QVector<DuplicateMatch> &matches, const QString &error);
+
+private:
+    DatabaseManager *m_dbManager;
+    QThread m_thread;
+    bool m_running;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // DUPLICATEFINDER_H
@@ -0,0 +1,139 @@
+#include "duplicatesdialog.h"
+#include "databasemanager.h"
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSet>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <utility>
+
+DuplicatesDialog::DuplicatesDialog(DatabaseManager *dbManager, QWidget *parent)
+    : QDialog(parent)
+    , m_dbManager(dbManager)
+    , m_scanner(new DuplicateScanner(dbManager, this))
+{
+    setWindowTitle("Find Duplicates");
+    setModal(true);
+
+    m_statusLabel = new QLabel("Starting scan...", this);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({"Score", "Keep", "Duplicate", "Reasons"});
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_mergeButton = buttonBox->addButton("Merge Selected", QDialogButtonBox::ActionRole);
+    m_mergeButton->setEnabled(false);
+
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_mergeButton, &QPushButton::clicked, this, &DuplicatesDialog::onMergeClicked);
+    connect(m_table->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &DuplicatesDialog::updateButtonStates);
+    connect(m_scanner, &DuplicateScanner::statusChanged, m_statusLabel, &QLabel::setText);
+    connect(m_scanner, &DuplicateScanner::finished, this, &DuplicatesDialog::onScanFinished);
+    connect(this, &QDialog::finished, m_scanner, &DuplicateScanner::cancel);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(m_statusLabel);
+    mainLayout->addWidget(m_table);
+    mainLayout->addWidget(buttonBox);
+    setLayout(mainLayout);
+
+    resize(900, 500);
+
+    if (!m_scanner->start()) {
+        m_statusLabel->setText("Not connected to database");
+    }
+}
+
+void DuplicatesDialog::onScanFinished(const QVector<DuplicateMatch> &matches, const QString &error)
+{
+    if (!error.isEmpty()) {
+        m_statusLabel->setText("Scan failed: " + error);
+        return;
+    }
+
+    m_matches = matches;
+    m_table->setRowCount(m_matches.size());
+    for (int row = 0; row < m_matches.size(); ++row) {
+        const DuplicateMatch &match = m_matches.at(row);
+        m_table->setItem(row, ScoreColumn,
+                         new QTableWidgetItem(QString::number(match.score * 100, 'f', 0) + "%"));
+        m_table->setItem(row, KeepColumn, new QTableWidgetItem(describe(match.first)));
+        m_table->setItem(row, DuplicateColumn, new QTableWidgetItem(describe(match.second)));
+        m_table->setItem(row, ReasonsColumn, new QTableWidgetItem(match.reasons.join(", ")));
+    }
+    m_table->resizeColumnsToContents();
+
+    m_statusLabel->setText(m_matches.isEmpty()
+                               ? "No duplicates found"
+                               : QString("%1 possible duplicates").arg(m_matches.size()));
+}
+
+void DuplicatesDialog::onMergeClicked()
+{
+    QList<int> rows;
+    for (const QModelIndex &index : m_table->selectionModel()->selectedRows()) {
+        rows.append(index.row());
+    }
+    std::sort(rows.begin(), rows.end());
+
+    // A contact merged away by an earlier row cannot take part in a later one
+    QSet<int> removedIds;
+    QList<int> mergedRows;
+    int skipped = 0;
+    for (int row : std::as_const(rows)) {
+        const DuplicateMatch &match = m_matches.at(row);
+        if (removedIds.contains(match.first.id) || removedIds.contains(match.second.id)) {
+            ++skipped;
+            continue;
+        }
+
+        // Re-read the survivor; an earlier merge may have filled it in
+        Contact keep = m_dbManager->getContact(match.first.id);
+        if (keep.id <= 0) {
+            ++skipped;
+            continue;
+        }
+
+        Contact merged = DuplicateFinder::merged(keep, match.second);
+        if (!m_dbManager->mergeContacts(merged, {match.second.id})) {
+            QMessageBox::warning(this, "Merge Error",
+                                 "Failed to merge contacts: " + m_dbManager->lastError());
+            break;
+        }
+        removedIds.insert(match.second.id);
+        mergedRows.append(row);
+    }
+
+    for (auto it = mergedRows.crbegin(); it != mergedRows.crend(); ++it) {
+        m_table->removeRow(*it);
+        m_matches.removeAt(*it);
+    }
+
+    QString message = QString("Merged %1 contacts").arg(mergedRows.size());
+    if (skipped > 0) {
+        message += QString(", skipped %1 already merged").arg(skipped);
+    }
+    m_statusLabel->setText(message);
+}
+
+void DuplicatesDialog::updateButtonStates()
+{
+    m_mergeButton->setEnabled(m_table->selectionModel()->hasSelection());
+}
+
+QString DuplicatesDialog::describe(const Contact &contact)
+{
+    QStringList parts = {contact.fullName()};
+    if (!contact.email.isEmpty()) parts.append(contact.email);
+    if (!contact.phone.isEmpty()) parts.append(contact.phone);
+    return parts.join(", ");
+}
@@ -0,0 +1,51 @@
+#ifndef DUPLICATESDIALOG_H
+#define DUPLICATESDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include "duplicatefinder.h"
+
+class DatabaseManager;
+class QLabel;
+class QPushButton;
+class QTableWidget;
+
+/**
+ * @brief Lists merge suggestions from a background duplicate scan
+ *
+ * Each row pairs a contact with a probable duplicate; merging keeps the
+ * older contact, fills its empty fields from the newer one and deletes
+ * the newer one.
+ */
+class DuplicatesDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicatesDialog(DatabaseManager *dbManager, QWidget *parent = nullptr);
+
+private slots:
+    void onScanFinished(const QVector<DuplicateMatch> &matches, const QString &error);
+    void onMergeClicked();
+    void updateButtonStates();
+
+private:
+    enum Column {
+        ScoreColumn,
+        KeepColumn,
+        DuplicateColumn,
+        ReasonsColumn,
+        ColumnCount
+    };
+
+    DatabaseManager *m_dbManager;
+    DuplicateScanner *m_scanner;
+    QVector<DuplicateMatch> m_matches;
+    QLabel *m_statusLabel;
+    QTableWidget *m_table;
+    QPushButton *m_mergeButton;
+
+    static QString describe(const Contact &contact);
+};
+
+#endif // DUPLICATESDIALOG_H
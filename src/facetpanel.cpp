@@ -0,0 +1,171 @@
+#include "facetpanel.h"
+#include "databasemanager.h"
+#include <QLabel>
+#include <QListWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+
+// Holds the item's count next to its value (Qt::UserRole)
+const int CountRole = Qt::UserRole + 1;
+
+void setCount(QListWidgetItem *item, int count)
+{
+    const QString value = item->data(Qt::UserRole).toString();
+    const QString label = value.isEmpty() ? QString("(none)") : value;
+    item->setText(QString("%1 (%2)").arg(label).arg(count));
+    item->setData(CountRole, count);
+}
+
+} // namespace
+
+FacetPanel::FacetPanel(DatabaseManager *dbManager, QWidget *parent)
+    : QDockWidget("Facets", parent)
+    , m_dbManager(dbManager)
+    , m_refreshTimer(new QTimer(this))
+{
+    setObjectName("facetPanel");
+    setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+    m_countryList = new QListWidget(this);
+    m_countryList->setProperty("facet", int(CountryFacet));
+    m_cityList = new QListWidget(this);
+    m_cityList->setProperty("facet", int(CityFacet));
+
+    QWidget *contents = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(contents);
+    layout->addWidget(new QLabel("Countries", contents));
+    layout->addWidget(m_countryList);
+    layout->addWidget(new QLabel("Cities", contents));
+    layout->addWidget(m_cityList);
+    setWidget(contents);
+
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(RefreshDelayMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &FacetPanel::refresh);
+
+    connect(m_countryList, &QListWidget::itemClicked, this, &FacetPanel::onItemActivated);
+    connect(m_cityList, &QListWidget::itemClicked, this, &FacetPanel::onItemActivated);
+
+    connect(m_dbManager, &DatabaseManager::databaseConnected, this, &FacetPanel::refresh);
+    connect(m_dbManager, &DatabaseManager::databaseDisconnected, this, &FacetPanel::clear);
+    connect(m_dbManager, &DatabaseManager::contactAdded, this, &FacetPanel::onContactAdded);
+    connect(m_dbManager, &DatabaseManager::contactUpdated, this, &FacetPanel::onContactUpdated);
+    connect(m_dbManager, &DatabaseManager::contactDeleted, this, &FacetPanel::onContactDeleted);
+    connect(m_dbManager, &DatabaseManager::contactsImported, this, &FacetPanel::scheduleRefresh);
+    connect(m_dbManager, &DatabaseManager::contactsDeleted, this, &FacetPanel::scheduleRefresh);
+    connect(m_dbManager, &DatabaseManager::contactsUpdated, this, &FacetPanel::scheduleRefresh);
+}
+
+void FacetPanel::refresh()
+{
+    m_refreshTimer->stop();
+    if (!m_dbManager->isConnected()) {
+        clear();
+        return;
+    }
+
+    fillList(m_countryList, CountryFacet);
+    fillList(m_cityList, CityFacet);
+}
+
+void FacetPanel::clear()
+{
+    m_refreshTimer->stop();
+    m_countryList->clear();
+    m_cityList->clear();
+    m_countryItems.clear();
+    m_cityItems.clear();
+}
+
+void FacetPanel::scheduleRefresh()
+{
+    // Restarting would starve the panel during a long import
+    if (!m_refreshTimer->isActive()) {
+        m_refreshTimer->start();
+    }
+}
+
+void FacetPanel::onItemActivated(QListWidgetItem *item)
+{
+    const ContactFacet facet = ContactFacet(item->listWidget()->property("facet").toInt());
+    emit facetSelected(facet, item->data(Qt::UserRole).toString());
+}
+
+void FacetPanel::onContactAdded(const Contact &contact)
+{
+    adjust(CountryFacet, contact.country, 1);
+    adjust(CityFacet, contact.city, 1);
+}
+
+void FacetPanel::onContactUpdated(const Contact &previous, const Contact &current)
+{
+    if (previous.country != current.country) {
+        adjust(CountryFacet, previous.country, -1);
+        adjust(CountryFacet, current.country, 1);
+    }
+    if (previous.city != current.city) {
+        adjust(CityFacet, previous.city, -1);
+        adjust(CityFacet, current.city, 1);
+    }
+}
+
+void FacetPanel::onContactDeleted(const Contact &contact)
+{
+    adjust(CountryFacet, contact.country, -1);
+    adjust(CityFacet, contact.city, -1);
+}
+
+void FacetPanel::adjust(ContactFacet facet, const QString &value, int delta)
+{
+    // A pending full load will pick the change up anyway
+    if (m_refreshTimer->isActive()) return;
+
+    QListWidget *list = facet == CountryFacet ? m_countryList : m_cityList;
+    QHash<QString, QListWidgetItem *> &items = facet == CountryFacet ? m_countryItems : m_cityItems;
+
+    QListWidgetItem *item = items.value(value);
+    if (!item) {
+        if (delta <= 0) return;
+        item = new QListWidgetItem(list);
+        item->setData(Qt::UserRole, value);
+        items.insert(value, item);
+        setCount(item, delta);
+        return;
+    }
+
+    const int count = item->data(CountRole).toInt() + delta;
+    if (count <= 0) {
+        items.remove(value);
+        delete item;
+        return;
+    }
+    setCount(item, count);
+}
+
+void FacetPanel::fillList(QListWidget *list, ContactFacet facet)
+{
+    const QVector<FacetCount> counts = m_dbManager->getFacetCounts(facet);
+    QHash<QString, QListWidgetItem *> &items = facet == CountryFacet ? m_countryItems : m_cityItems;
+
+    // Keep the selection across refreshes
+    const QListWidgetItem *current = list->currentItem();
+    const QString selected = current ? current->data(Qt::UserRole).toString() : QString();
+    const bool hadSelection = current != nullptr;
+
+    list->setUpdatesEnabled(false);
+    list->clear();
+    items.clear();
+    items.reserve(counts.size());
+    for (const FacetCount &count : counts) {
+        QListWidgetItem *item = new QListWidgetItem(list);
+        item->setData(Qt::UserRole, count.value);
+        setCount(item, count.count);
+        items.insert(count.value, item);
+        if (hadSelection && count.value == selected) {
+            list->setCurrentItem(item);
+        }
+    }
+    list->setUpdatesEnabled(true);
+}
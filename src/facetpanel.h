@@ -0,0 +1,61 @@
+#ifndef FACETPANEL_H
+#define FACETPANEL_H
+
+#include <QDockWidget>
+#include <QHash>
+#include "contact.h"
+#include "storageengine.h"
+
+class DatabaseManager;
+class QListWidget;
+class QListWidgetItem;
+class QTimer;
+
+/**
+ * @brief Dock listing contact counts per country and per city
+ *
+ * The lists are loaded from DatabaseManager::getFacetCounts(), which
+ * reads totals the storage engine keeps up to date on every write. After
+ * that, single-contact changes only adjust the one or two entries they
+ * touch; new values are appended and the count order is restored by the
+ * next full load. Full loads happen on connect and, coalesced, after
+ * bulk changes (imports, multi-row edits). Clicking an entry emits
+ * facetSelected().
+ */
+class FacetPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int RefreshDelayMs = 200;
+
+    explicit FacetPanel(DatabaseManager *dbManager, QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+    void clear();
+
+signals:
+    void facetSelected(ContactFacet facet, const QString &value);
+
+private slots:
+    void scheduleRefresh();
+    void onItemActivated(QListWidgetItem *item);
+    void onContactAdded(const Contact &contact);
+    void onContactUpdated(const Contact &previous, const Contact &current);
+    void onContactDeleted(const Contact &contact);
+
+private:
+    DatabaseManager *m_dbManager;
+    QListWidget *m_countryList;
+    QListWidget *m_cityList;
+    // Entry per facet value, for in-place updates
+    QHash<QString, QListWidgetItem *> m_countryItems;
+    QHash<QString, QListWidgetItem *> m_cityItems;
+    QTimer *m_refreshTimer;
+
+    void fillList(QListWidget *list, ContactFacet facet);
+    void adjust(ContactFacet facet, const QString &value, int delta);
+};
+
+#endif // FACETPANEL_H
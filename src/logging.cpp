@@ -0,0 +1,4 @@
+#include "logging.h"
+
+Q_LOGGING_CATEGORY(lcDatabase, "contactmanager.database", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcNetwork, "contactmanager.network", QtInfoMsg)
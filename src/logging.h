@@ -0,0 +1,12 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+
+// Per-row and per-request messages. Debug output is off by default; turn
+// it on with e.g. QT_LOGGING_RULES="contactmanager.*.debug=true".
+// Warnings are always shown.
+Q_DECLARE_LOGGING_CATEGORY(lcDatabase)
+Q_DECLARE_LOGGING_CATEGORY(lcNetwork)
+
+#endif // LOGGING_H
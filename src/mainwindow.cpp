@@ -1,19 +1,82 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "memorystorageengine.h"
+#include "duplicatesdialog.h"
+#include "contactsnapshot.h"
+#include <QCloseEvent>
+#include <QTimer>
+#include <QMenu>
+#include <QMenuBar>
 #include <QMessageBox>
 #include <QDebug>
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QProgressBar>
+#include <QCheckBox>
+#include <QInputDialog>
+
+// Number of rows inspected when sizing columns to their contents
+static const int ColumnSizeSampleRows = 200;
+// Search results are ranked, so only the best matches are shown
+static const int SearchResultLimit = 1000;
+// Rows shown when filtering by a country or city
+static const int FacetResultLimit = 10000;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , m_httpServer(nullptr)
+    , m_firstPaintReported(false)
+    , m_showingSnapshot(false)
 {
+    m_startupTimer.start();
     ui->setupUi(this);
     
     // Initialize managers
     m_dbManager = new DatabaseManager(this);
+    // Kiosk deployments can run from memory, optionally backed by a log file
+    if (qEnvironmentVariable("CONTACTMANAGER_STORAGE") == "memory") {
+        m_dbManager->setStorageEngine(std::make_unique<MemoryStorageEngine>(
+            qEnvironmentVariable("CONTACTMANAGER_MEMORY_LOG")));
+    }
     m_networkManager = new NetworkManager(this);
+    m_contactModel = new ContactTableModel(m_dbManager, this);
+    m_searcher = new ContactSearcher(m_dbManager, this);
+    m_searcher->setResultLimit(SearchResultLimit);
+    m_importer = new ContactImporter(m_dbManager, this);
+    m_exporter = new ContactExporter(m_dbManager, this);
+    m_facetPanel = new FacetPanel(m_dbManager, this);
+    addDockWidget(Qt::LeftDockWidgetArea, m_facetPanel);
+    m_diagnosticsPanel = new DiagnosticsPanel(m_dbManager, m_networkManager, this);
+    addDockWidget(Qt::RightDockWidgetArea, m_diagnosticsPanel);
+    m_diagnosticsPanel->hide();
+    
+    QMenu *viewMenu = ui->menubar->addMenu("&View");
+    viewMenu->addAction(m_facetPanel->toggleViewAction());
+    viewMenu->addAction(m_diagnosticsPanel->toggleViewAction());
+    QMenu *toolsMenu = ui->menubar->addMenu("&Tools");
+    toolsMenu->addAction("Fetch &Many from API...", this, &MainWindow::onFetchBatchClicked);
+    
+    // Local tools can reach the book over HTTP; never bound beyond localhost
+    const int httpPort = qEnvironmentVariableIntValue("CONTACTMANAGER_HTTP_PORT");
+    if (httpPort > 0 && httpPort <= 65535) {
+        m_httpServer = new ContactHttpServer(m_dbManager, this);
+        if (!m_httpServer->start(quint16(httpPort))) {
+            delete m_httpServer;
+            m_httpServer = nullptr;
+        }
+    }
+    
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setMaximumWidth(200);
+    m_progressBar->hide();
+    ui->statusbar->addPermanentWidget(m_progressBar);
+    
+    setupContactTable();
+    ui->tableView_contacts->viewport()->installEventFilter(this);
     
     // Setup signal/slot connections
     setupConnections();
@@ -21,14 +84,61 @@ MainWindow::MainWindow(QWidget *parent)
     // Initial UI state
     updateButtonStates();
     
-    showStatusMessage("Welcome! Please connect to database to begin.");
+    // A snapshot means the last session was connected: show its rows now
+    // and reconnect in the background
+    if (showSnapshot()) {
+        QTimer::singleShot(0, this, &MainWindow::onConnectClicked);
+    } else {
+        showStatusMessage("Welcome! Please connect to database to begin.");
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    // Every worker thread reads through m_dbManager's storage engine, and
+    // m_dbManager, as the oldest child, would be destroyed first: cancel
+    // and join them all while the engine is still open
+    if (m_httpServer) {
+        m_httpServer->stop();
+    }
+    delete m_searcher;
+    m_searcher = nullptr;
+    delete m_importer;
+    m_importer = nullptr;
+    delete m_exporter;
+    m_exporter = nullptr;
     delete ui;
 }
 
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    saveSnapshot();
+    QMainWindow::closeEvent(event);
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (!m_firstPaintReported && event->type() == QEvent::Paint
+        && watched == ui->tableView_contacts->viewport()) {
+        m_firstPaintReported = true;
+        ui->tableView_contacts->viewport()->removeEventFilter(this);
+        qDebug() << "First paint after" << m_startupTimer.elapsed() << "ms with"
+                 << m_contactModel->rowCount() << (m_showingSnapshot ? "cached" : "live") << "rows";
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::setupContactTable()
+{
+    QTableView *view = ui->tableView_contacts;
+    view->setModel(m_contactModel);
+
+    // Uniform row heights let the view skip measuring every row
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->horizontalHeader()->setResizeContentsPrecision(ColumnSizeSampleRows);
+    view->horizontalHeader()->setStretchLastSection(true);
+}
+
 void MainWindow::setupConnections()
 {
     // Database connection signals
@@ -51,12 +161,40 @@ void MainWindow::setupConnections()
     connect(ui->pushButton_refresh, &QPushButton::clicked,
             this, &MainWindow::onRefreshClicked);
     
+    // Import
+    connect(ui->pushButton_import, &QPushButton::clicked,
+            this, &MainWindow::onImportClicked);
+    connect(m_importer, &ContactImporter::progress,
+            this, &MainWindow::onImportProgress);
+    connect(m_importer, &ContactImporter::finished,
+            this, &MainWindow::onImportFinished);
+    
+    // Export
+    connect(ui->pushButton_export, &QPushButton::clicked,
+            this, &MainWindow::onExportClicked);
+    connect(m_exporter, &ContactExporter::progress,
+            this, &MainWindow::onExportProgress);
+    connect(m_exporter, &ContactExporter::finished,
+            this, &MainWindow::onExportFinished);
+    
+    // Duplicate detection
+    connect(ui->pushButton_duplicates, &QPushButton::clicked,
+            this, &MainWindow::onFindDuplicatesClicked);
+    
+    // Facet filtering
+    connect(m_facetPanel, &FacetPanel::facetSelected,
+            this, &MainWindow::onFacetSelected);
+    
     // Search functionality
     connect(ui->lineEdit_search, &QLineEdit::textChanged,
             this, &MainWindow::onSearchTextChanged);
+    connect(m_searcher, &ContactSearcher::resultsReady,
+            this, &MainWindow::onSearchResultsReady);
+    connect(m_searcher, &ContactSearcher::searchFailed,
+            this, &MainWindow::onDatabaseError);
     
     // Table selection
-    connect(ui->tableWidget_contacts, &QTableWidget::itemSelectionChanged,
+    connect(ui->tableView_contacts->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &MainWindow::onTableSelectionChanged);
     
     // Network signals
@@ -64,6 +202,10 @@ void MainWindow::setupConnections()
             this, &MainWindow::onFetchFromApiClicked);
     connect(m_networkManager, &NetworkManager::contactFetched,
             this, &MainWindow::onContactFetched);
+    connect(m_networkManager, &NetworkManager::batchProgress,
+            this, &MainWindow::onBatchProgress);
+    connect(m_networkManager, &NetworkManager::contactsFetched,
+            this, &MainWindow::onContactsFetched);
     connect(m_networkManager, &NetworkManager::fetchStarted,
             this, &MainWindow::onNetworkFetchStarted);
     connect(m_networkManager, &NetworkManager::fetchFinished,
@@ -71,12 +213,19 @@ void MainWindow::setupConnections()
     connect(m_networkManager, &NetworkManager::errorOccurred,
             this, &MainWindow::onNetworkError);
     
-    // Database CRUD signals for UI updates
+    // Database CRUD signals for UI updates; single-row changes are
+    // applied to the model in place, bulk inserts reload it
     connect(m_dbManager, &DatabaseManager::contactAdded,
-            this, [this](int) { loadContacts(); });
+            m_contactModel, &ContactTableModel::onContactAdded);
     connect(m_dbManager, &DatabaseManager::contactUpdated,
-            this, [this](int) { loadContacts(); });
+            m_contactModel, &ContactTableModel::onContactUpdated);
     connect(m_dbManager, &DatabaseManager::contactDeleted,
+            m_contactModel, &ContactTableModel::onContactDeleted);
+    connect(m_dbManager, &DatabaseManager::contactsUpdated,
+            m_contactModel, &ContactTableModel::onContactsUpdated);
+    connect(m_dbManager, &DatabaseManager::contactsDeleted,
+            m_contactModel, &ContactTableModel::onContactsDeleted);
+    connect(m_dbManager, &DatabaseManager::contactsImported,
             this, [this](int) { loadContacts(); });
 }
 
@@ -87,7 +236,6 @@ void MainWindow::onConnectClicked()
     QString host = ui->lineEdit_host->text();
     QString database = ui->lineEdit_database->text();
     QString user = ui->lineEdit_user->text();
-    QString password = ui->lineEdit_password->text();
     
     if (host.isEmpty() || database.isEmpty() || user.isEmpty()) {
         QMessageBox::warning(this, "Input Error", 
@@ -96,19 +244,18 @@ void MainWindow::onConnectClicked()
     }
     
     showStatusMessage("Connecting to database...");
+    ui->pushButton_connect->setEnabled(false);
     
-    if (m_dbManager->connectToDatabase(host, database, user, password)) {
-
-        if (!m_dbManager->createTable()) {
-            QMessageBox::warning(this, "Database Error",
-                               "Connected but failed to create table: " + 
-                               m_dbManager->lastError());
-        }
-    } else {
+    // Opened and schema-checked off the GUI thread; onDatabaseConnected()
+    // follows on success
+    m_dbManager->connectToDatabaseAsync().then(this, [this](bool connected) {
+        if (connected) return;
+        
+        ui->pushButton_connect->setEnabled(true);
         QMessageBox::critical(this, "Connection Error",
                             "Failed to connect to database:\n" + 
                             m_dbManager->lastError());
-    }
+    });
 }
 
 void MainWindow::onDatabaseConnected()
@@ -124,8 +271,14 @@ void MainWindow::onDatabaseConnected()
     ui->lineEdit_password->setEnabled(false);
     
     updateButtonStates();
+    // Replaces any snapshot rows with the live list
     loadContacts();
     
+    if (m_showingSnapshot) {
+        m_showingSnapshot = false;
+        qDebug() << "Live contacts replaced the snapshot after" << m_startupTimer.elapsed() << "ms";
+    }
+    
     showStatusMessage("Successfully connected to database!");
 }
 
@@ -151,28 +304,30 @@ void MainWindow::onAddContactClicked()
     Contact newContact = showContactDialog("Add New Contact");
     
     if (newContact.isValid()) {
-        if (m_dbManager->addContact(newContact)) {
-            showStatusMessage("Contact added successfully!");
-        } else {
-            QMessageBox::warning(this, "Error", 
-                               "Failed to add contact: " + m_dbManager->lastError());
-        }
+        // Committed in the background; contactAdded() updates the table
+        m_dbManager->addContactAsync(newContact).then(this, [this](const WriteResult &result) {
+            if (result.succeeded()) {
+                showStatusMessage("Contact added successfully!");
+            } else {
+                QMessageBox::warning(this, "Error", "Failed to add contact: " + result.error);
+            }
+        });
     }
 }
 
 void MainWindow::onEditContactClicked()
 {
-    int currentRow = ui->tableWidget_contacts->currentRow();
-    if (currentRow < 0) return;
-
-    // Get contact ID from UserRole data
-    QTableWidgetItem *item = ui->tableWidget_contacts->item(currentRow, 0);
-    if (!item) {
-        QMessageBox::warning(this, "Error", "Cannot retrieve contact information");
+    QVector<int> ids = selectedContactIds();
+    if (ids.size() > 1) {
+        editSelectedContacts(ids);
         return;
     }
 
-    int contactId = item->data(Qt::UserRole).toInt();
+    int currentRow = currentContactRow();
+    if (currentRow < 0) return;
+
+    Contact rowContact = m_contactModel->contactAt(currentRow);
+    int contactId = rowContact.id;
 
     if (contactId <= 0) {
         QMessageBox::warning(this, "Error", "Invalid contact ID");
@@ -190,36 +345,39 @@ void MainWindow::onEditContactClicked()
 
     if (updatedContact.isValid()) {
         updatedContact.id = contactId;
-        if (m_dbManager->updateContact(updatedContact)) {
+        m_dbManager->updateContactAsync(updatedContact).then(this, [this](const WriteResult &result) {
+            if (!result.succeeded()) {
+                QMessageBox::warning(this, "Error", "Failed to update contact: " + result.error);
+                return;
+            }
+            // contactUpdated() has already put the row in place; follow a
+            // renamed contact to its new sorted position
+            selectContact(result.contact);
             showStatusMessage("Contact updated successfully!");
-        } else {
-            QMessageBox::warning(this, "Error",
-                                 "Failed to update contact: " + m_dbManager->lastError());
-        }
+        });
     }
 }
 
 void MainWindow::onDeleteContactClicked()
 {
-    int currentRow = ui->tableWidget_contacts->currentRow();
-    if (currentRow < 0) return;
-
-    // Get contact ID from UserRole data
-    QTableWidgetItem *item = ui->tableWidget_contacts->item(currentRow, 0);
-    if (!item) {
-        QMessageBox::warning(this, "Error", "Cannot retrieve contact information");
+    QVector<int> ids = selectedContactIds();
+    if (ids.size() > 1) {
+        deleteSelectedContacts(ids);
         return;
     }
 
-    int contactId = item->data(Qt::UserRole).toInt();
+    int currentRow = currentContactRow();
+    if (currentRow < 0) return;
+
+    Contact rowContact = m_contactModel->contactAt(currentRow);
+    int contactId = rowContact.id;
 
     if (contactId <= 0) {
         QMessageBox::warning(this, "Error", "Invalid contact ID");
         return;
     }
 
-    QString contactName = ui->tableWidget_contacts->item(currentRow, 0)->text() + " " +
-                          ui->tableWidget_contacts->item(currentRow, 1)->text();
+    QString contactName = rowContact.fullName();
 
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "Confirm Deletion",
@@ -228,12 +386,13 @@ void MainWindow::onDeleteContactClicked()
         );
 
     if (reply == QMessageBox::Yes) {
-        if (m_dbManager->deleteContact(contactId)) {
-            showStatusMessage("Contact deleted successfully!");
-        } else {
-            QMessageBox::warning(this, "Error",
-                                 "Failed to delete contact: " + m_dbManager->lastError());
-        }
+        m_dbManager->deleteContactAsync(contactId).then(this, [this](const WriteResult &result) {
+            if (result.succeeded()) {
+                showStatusMessage("Contact deleted successfully!");
+            } else {
+                QMessageBox::warning(this, "Error", "Failed to delete contact: " + result.error);
+            }
+        });
     }
 }
 
@@ -252,7 +411,21 @@ void MainWindow::onSearchTextChanged(const QString &text)
 {
     if (!m_dbManager->isConnected()) return;
     
-    QVector<Contact> contacts = m_dbManager->searchContacts(text);
+    if (text.trimmed().isEmpty()) {
+        m_searcher->cancel();
+        loadContacts();
+        return;
+    }
+    
+    // Runs on the searcher's thread once typing pauses
+    m_searcher->requestSearch(text);
+}
+
+void MainWindow::onSearchResultsReady(const QString &searchTerm, const QVector<Contact> &contacts)
+{
+    // The box may have been cleared while the query was running
+    if (ui->lineEdit_search->text() != searchTerm) return;
+    
     displayContacts(contacts);
 }
 
@@ -261,6 +434,150 @@ void MainWindow::onTableSelectionChanged()
     updateButtonStates();
 }
 
+// ============= Facet Slots =============
+
+void MainWindow::onFacetSelected(ContactFacet facet, const QString &value)
+{
+    if (!m_dbManager->isConnected()) return;
+
+    m_searcher->cancel();
+    ui->lineEdit_search->blockSignals(true);
+    ui->lineEdit_search->clear();
+    ui->lineEdit_search->blockSignals(false);
+
+    const QVector<Contact> contacts = m_dbManager->getContactsByFacet(facet, value, FacetResultLimit);
+    displayContacts(contacts);
+
+    const QString label = value.isEmpty()
+                              ? QString(facet == CountryFacet ? "no country" : "no city")
+                              : value;
+    showStatusMessage(QString("Showing %1 contacts in %2 (Refresh to show all)")
+                          .arg(contacts.size()).arg(label), 5000);
+}
+
+// ============= Import Slots =============
+
+void MainWindow::onImportClicked()
+{
+    if (m_importer->isRunning()) {
+        m_importer->cancel();
+        showStatusMessage("Cancelling import...");
+        return;
+    }
+    
+    QString filePath = QFileDialog::getOpenFileName(
+        this, "Import Contacts", QString(),
+        "Contact files (*.csv *.vcf *.vcard);;CSV files (*.csv);;vCard files (*.vcf *.vcard)");
+    
+    if (filePath.isEmpty()) return;
+    
+    if (!m_importer->start(filePath)) {
+        QMessageBox::warning(this, "Import Error", "Could not start the import.");
+        return;
+    }
+    
+    ui->pushButton_import->setText("Cancel Import");
+    m_progressBar->setValue(0);
+    m_progressBar->show();
+    showStatusMessage("Importing " + filePath + "...", 0);
+}
+
+void MainWindow::onImportProgress(qint64 bytesRead, qint64 totalBytes, int imported)
+{
+    if (totalBytes > 0) {
+        m_progressBar->setValue(int(bytesRead * 100 / totalBytes));
+    }
+    showStatusMessage(QString("Imported %1 contacts...").arg(imported), 0);
+}
+
+void MainWindow::onImportFinished(const ImportSummary &summary)
+{
+    ui->pushButton_import->setText("Import...");
+    m_progressBar->hide();
+    
+    if (!summary.succeeded()) {
+        QMessageBox::warning(this, "Import Error",
+                           QString("Import stopped after %1 contacts:\n%2")
+                               .arg(summary.imported).arg(summary.error));
+    } else {
+        showStatusMessage(QString("Import %1: %2 contacts added, %3 skipped")
+                              .arg(summary.cancelled ? "cancelled" : "finished")
+                              .arg(summary.imported).arg(summary.skipped), 5000);
+    }
+    // The table and facets reload on DatabaseManager::contactsImported()
+}
+
+// ============= Export Slots =============
+
+void MainWindow::onExportClicked()
+{
+    if (m_exporter->isRunning()) {
+        m_exporter->cancel();
+        showStatusMessage("Cancelling export...");
+        return;
+    }
+    
+    QString filePath = QFileDialog::getSaveFileName(
+        this, "Export Contacts", "contacts.csv",
+        "CSV files (*.csv);;vCard files (*.vcf *.vcard);;JSON lines (*.ndjson *.jsonl)");
+    
+    if (filePath.isEmpty()) return;
+    
+    if (!ContactExporter::isSupportedFile(filePath)) {
+        QMessageBox::warning(this, "Export Error",
+                           "Please choose a .csv, .vcf, .vcard, .ndjson or .jsonl file name.");
+        return;
+    }
+    
+    if (!m_exporter->start(filePath)) {
+        QMessageBox::warning(this, "Export Error", "Could not start the export.");
+        return;
+    }
+    
+    ui->pushButton_export->setText("Cancel Export");
+    m_progressBar->setValue(0);
+    m_progressBar->show();
+    showStatusMessage("Exporting to " + filePath + "...", 0);
+}
+
+void MainWindow::onExportProgress(int exported, int total)
+{
+    if (total > 0) {
+        m_progressBar->setValue(int(qint64(exported) * 100 / total));
+    }
+    showStatusMessage(QString("Exported %1 contacts...").arg(exported), 0);
+}
+
+void MainWindow::onExportFinished(const ExportSummary &summary)
+{
+    ui->pushButton_export->setText("Export...");
+    m_progressBar->hide();
+    
+    if (!summary.succeeded()) {
+        QMessageBox::warning(this, "Export Error",
+                           QString("Export failed after %1 contacts:\n%2")
+                               .arg(summary.exported).arg(summary.error));
+    } else if (summary.cancelled) {
+        showStatusMessage("Export cancelled", 5000);
+    } else {
+        showStatusMessage(QString("Exported %1 contacts").arg(summary.exported), 5000);
+    }
+}
+
+// ============= Duplicate Detection =============
+
+void MainWindow::onFindDuplicatesClicked()
+{
+    if (!m_dbManager->isConnected()) {
+        showStatusMessage("Not connected to database");
+        return;
+    }
+    
+    // Merges go through DatabaseManager, so the table updates in place
+    DuplicatesDialog dialog(m_dbManager, this);
+    dialog.exec();
+}
+
 // ============= Network Slots =============
 
 void MainWindow::onFetchFromApiClicked()
@@ -280,11 +597,21 @@ void MainWindow::onContactFetched(const Contact &contact)
                              "Name: %1 %2\n"
                              "Email: %3\n"
                              "Phone: %4\n"
-                             "Location: %5, %6\n\n"
-                             "Would you like to add this contact to the database?")
+                             "Location: %5, %6\n\n")
                         .arg(contact.firstName, contact.lastName, contact.email,
                              contact.phone, contact.city, contact.country);
     
+    // Exact lookups are cheap, so warn before creating an obvious duplicate
+    QVector<Contact> existing = m_dbManager->findByEmail(contact.email);
+    if (existing.isEmpty()) {
+        existing = m_dbManager->findByPhone(contact.phone);
+    }
+    if (!existing.isEmpty()) {
+        message += QString("A contact with this email or phone already exists (%1).\n\n")
+                       .arg(existing.first().fullName());
+    }
+    message += "Would you like to add this contact to the database?";
+    
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "Add Fetched Contact", message,
         QMessageBox::Yes | QMessageBox::No
@@ -300,6 +627,48 @@ void MainWindow::onContactFetched(const Contact &contact)
     }
 }
 
+void MainWindow::onFetchBatchClicked()
+{
+    if (!m_dbManager->isConnected()) {
+        showStatusMessage("Not connected to database");
+        return;
+    }
+    if (m_networkManager->isBatchRunning()) {
+        showStatusMessage("A batch fetch is already in progress...");
+        return;
+    }
+    
+    bool ok = false;
+    const int count = QInputDialog::getInt(this, "Fetch Many from API",
+                                           "Number of contacts to fetch:",
+                                           100, 1, 100000, 100, &ok);
+    if (!ok) return;
+    
+    m_progressBar->setValue(0);
+    m_progressBar->show();
+    m_networkManager->fetchRandomContacts(count);
+}
+
+void MainWindow::onBatchProgress(int fetched, int requested)
+{
+    m_progressBar->setValue(requested > 0 ? fetched * 100 / requested : 0);
+    showStatusMessage(QString("Fetched %1 of %2 contacts...").arg(fetched).arg(requested));
+}
+
+void MainWindow::onContactsFetched(const QVector<Contact> &contacts)
+{
+    m_progressBar->hide();
+    
+    // One transaction for the whole batch
+    const int added = m_dbManager->addContacts(contacts);
+    if (added < 0) {
+        QMessageBox::warning(this, "Error",
+                           "Failed to add fetched contacts: " + m_dbManager->lastError());
+        return;
+    }
+    showStatusMessage(QString("Added %1 fetched contacts").arg(added));
+}
+
 void MainWindow::onNetworkFetchStarted()
 {
     ui->pushButton_fetch->setEnabled(false);
@@ -309,6 +678,7 @@ void MainWindow::onNetworkFetchStarted()
 void MainWindow::onNetworkFetchFinished()
 {
     ui->pushButton_fetch->setEnabled(true);
+    m_progressBar->hide();
 }
 
 void MainWindow::onNetworkError(const QString &error)
@@ -323,54 +693,95 @@ void MainWindow::loadContacts()
 {
     if (!m_dbManager->isConnected()) return;
     
-    QVector<Contact> contacts = m_dbManager->getAllContacts();
+    m_contactModel->reload();
+    resizeColumnsFromSample();
+}
+
+bool MainWindow::showSnapshot()
+{
+    QVector<Contact> contacts;
+    QString error;
+    if (!ContactSnapshot::read(ContactSnapshot::defaultPath(), snapshotSource(), &contacts, &error)) {
+        qDebug() << "No start-up snapshot:" << error;
+        return false;
+    }
+
     displayContacts(contacts);
+    m_showingSnapshot = true;
+    showStatusMessage(QString("Showing %1 cached contacts while connecting...").arg(contacts.size()));
+    return true;
+}
+
+void MainWindow::saveSnapshot()
+{
+    if (!m_dbManager->isConnected()) return;
+
+    const QVector<Contact> firstPage = m_dbManager->getContactsPage(Contact(), ContactTableModel::PageSize);
+    QString error;
+    if (!ContactSnapshot::write(ContactSnapshot::defaultPath(), snapshotSource(), firstPage, &error)) {
+        qWarning() << "Failed to save start-up snapshot:" << error;
+    }
+}
+
+QString MainWindow::snapshotSource() const
+{
+    // The engine choice and, for the memory engine, its log file
+    return m_dbManager->storageEngine()->name() + ":" + qEnvironmentVariable("CONTACTMANAGER_MEMORY_LOG");
 }
 
 void MainWindow::displayContacts(const QVector<Contact> &contacts)
 {
-    ui->tableWidget_contacts->setRowCount(0);
+    m_contactModel->setContacts(contacts);
+    resizeColumnsFromSample();
+}
 
-    for (const Contact &contact : contacts) {
-        int row = ui->tableWidget_contacts->rowCount();
-        ui->tableWidget_contacts->insertRow(row);
+void MainWindow::resizeColumnsFromSample()
+{
+    // Precision is capped in setupContactTable(), so only the first
+    // ColumnSizeSampleRows rows are measured
+    ui->tableView_contacts->resizeColumnsToContents();
+}
 
-        // Create items for each column
-        QTableWidgetItem *firstNameItem = new QTableWidgetItem(contact.firstName);
-        QTableWidgetItem *lastNameItem = new QTableWidgetItem(contact.lastName);
-        QTableWidgetItem *emailItem = new QTableWidgetItem(contact.email);
-        QTableWidgetItem *phoneItem = new QTableWidgetItem(contact.phone);
-        QTableWidgetItem *cityItem = new QTableWidgetItem(contact.city);
-        QTableWidgetItem *countryItem = new QTableWidgetItem(contact.country);
+void MainWindow::selectContact(const Contact &contact)
+{
+    int row = m_contactModel->rowOf(contact);
+    if (row < 0) return;
+    
+    ui->tableView_contacts->selectRow(row);
+    ui->tableView_contacts->scrollTo(m_contactModel->index(row, 0));
+}
 
-        // Store ID in UserRole of EVERY item for safety
-        firstNameItem->setData(Qt::UserRole, contact.id);
-        lastNameItem->setData(Qt::UserRole, contact.id);
-        emailItem->setData(Qt::UserRole, contact.id);
-        phoneItem->setData(Qt::UserRole, contact.id);
-        cityItem->setData(Qt::UserRole, contact.id);
-        countryItem->setData(Qt::UserRole, contact.id);
+int MainWindow::currentContactRow() const
+{
+    QModelIndex current = ui->tableView_contacts->currentIndex();
+    return current.isValid() ? current.row() : -1;
+}
 
-        ui->tableWidget_contacts->setItem(row, 0, firstNameItem);
-        ui->tableWidget_contacts->setItem(row, 1, lastNameItem);
-        ui->tableWidget_contacts->setItem(row, 2, emailItem);
-        ui->tableWidget_contacts->setItem(row, 3, phoneItem);
-        ui->tableWidget_contacts->setItem(row, 4, cityItem);
-        ui->tableWidget_contacts->setItem(row, 5, countryItem);
+QVector<int> MainWindow::selectedContactIds() const
+{
+    QVector<int> ids;
+    const QModelIndexList rows = ui->tableView_contacts->selectionModel()->selectedRows();
+    ids.reserve(rows.size());
+    for (const QModelIndex &index : rows) {
+        int id = index.data(ContactTableModel::IdRole).toInt();
+        if (id > 0) ids.append(id);
     }
-
-    ui->tableWidget_contacts->resizeColumnsToContents();
+    return ids;
 }
 
 void MainWindow::updateButtonStates()
 {
     bool connected = m_dbManager->isConnected();
-    bool hasSelection = ui->tableWidget_contacts->currentRow() >= 0;
+    bool hasSelection = currentContactRow() >= 0
+                        || ui->tableView_contacts->selectionModel()->hasSelection();
     
     ui->pushButton_add->setEnabled(connected);
     ui->pushButton_edit->setEnabled(connected && hasSelection);
     ui->pushButton_delete->setEnabled(connected && hasSelection);
     ui->pushButton_refresh->setEnabled(connected);
+    ui->pushButton_import->setEnabled(connected);
+    ui->pushButton_export->setEnabled(connected);
+    ui->pushButton_duplicates->setEnabled(connected);
 }
 
 void MainWindow::showStatusMessage(const QString &message, int timeout)
@@ -389,6 +800,41 @@ Contact MainWindow::showContactDialog(const QString &title, const Contact &conta
     return Contact(); // Return empty contact if cancelled
 }
 
+void MainWindow::editSelectedContacts(const QVector<int> &ids)
+{
+    BulkEditDialog dialog(ids.size(), this);
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    ContactPatch patch = dialog.getPatch();
+    if (patch.isEmpty()) return;
+
+    int updated = m_dbManager->updateContacts(ids, patch);
+    if (updated < 0) {
+        QMessageBox::warning(this, "Error",
+                             "Failed to update contacts: " + m_dbManager->lastError());
+        return;
+    }
+    showStatusMessage(QString("Updated %1 contacts").arg(updated));
+}
+
+void MainWindow::deleteSelectedContacts(const QVector<int> &ids)
+{
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, "Confirm Deletion",
+        QString("Are you sure you want to delete %1 contacts?").arg(ids.size()),
+        QMessageBox::Yes | QMessageBox::No
+        );
+    if (reply != QMessageBox::Yes) return;
+
+    int deleted = m_dbManager->deleteContacts(ids);
+    if (deleted < 0) {
+        QMessageBox::warning(this, "Error",
+                             "Failed to delete contacts: " + m_dbManager->lastError());
+        return;
+    }
+    showStatusMessage(QString("Deleted %1 contacts").arg(deleted));
+}
+
 // ============= ContactDialog Implementation =============
 
 ContactDialog::ContactDialog(const QString &title, const Contact &contact, QWidget *parent)
@@ -441,3 +887,68 @@ Contact ContactDialog::getContact() const
     
     return contact;
 }
+
+// ============= BulkEditDialog Implementation =============
+
+BulkEditDialog::BulkEditDialog(int contactCount, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(QString("Edit %1 Contacts").arg(contactCount));
+    setModal(true);
+
+    QFormLayout *formLayout = new QFormLayout();
+    const char *const labels[FieldCount] = {
+        "First Name:", "Last Name:", "Email:", "Phone:", "City:", "Country:"
+    };
+
+    for (int field = 0; field < FieldCount; ++field) {
+        m_enabled[field] = new QCheckBox(labels[field], this);
+        m_edits[field] = new QLineEdit(this);
+        m_edits[field]->setEnabled(false);
+        m_edits[field]->setPlaceholderText("Keep current values");
+        connect(m_enabled[field], &QCheckBox::toggled, m_edits[field], &QLineEdit::setEnabled);
+        formLayout->addRow(m_enabled[field], m_edits[field]);
+    }
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+
+    connect(buttonBox, &QDialogButtonBox::accepted, this, [this]() {
+        // Names are required, so they can be changed but not cleared
+        for (Field field : {FirstNameField, LastNameField}) {
+            if (m_enabled[field]->isChecked() && m_edits[field]->text().trimmed().isEmpty()) {
+                QMessageBox::warning(this, "Input Error", "First and last name cannot be empty.");
+                return;
+            }
+        }
+        accept();
+    });
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QLabel *hint = new QLabel("Tick the fields to set on every selected contact.", this);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(hint);
+    mainLayout->addLayout(formLayout);
+    mainLayout->addWidget(buttonBox);
+
+    setLayout(mainLayout);
+    setMinimumWidth(400);
+}
+
+ContactPatch BulkEditDialog::getPatch() const
+{
+    auto value = [this](Field field) -> std::optional<QString> {
+        if (!m_enabled[field]->isChecked()) return std::nullopt;
+        return m_edits[field]->text().trimmed();
+    };
+
+    ContactPatch patch;
+    patch.firstName = value(FirstNameField);
+    patch.lastName = value(LastNameField);
+    patch.email = value(EmailField);
+    patch.phone = value(PhoneField);
+    patch.city = value(CityField);
+    patch.country = value(CountryField);
+    return patch;
+}
@@ -6,12 +6,22 @@
 #include <QFormLayout>
 #include <QLineEdit>
 #include <QDialogButtonBox>
+#include <QElapsedTimer>
 #include "databasemanager.h"
 #include "networkmanager.h"
 #include "contact.h"
+#include "contacttablemodel.h"
+#include "contactsearcher.h"
+#include "contactimporter.h"
+#include "contactexporter.h"
+#include "facetpanel.h"
+#include "diagnosticspanel.h"
+#include "contacthttpserver.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QCheckBox;
+class QProgressBar;
 QT_END_NAMESPACE
 
 /**
@@ -28,6 +38,12 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    // Writes the first-page snapshot for the next start
+    void closeEvent(QCloseEvent *event) override;
+    // Times the first paint of the contact table
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private slots:
     // Database connection slots
     void onConnectClicked();
@@ -41,11 +57,31 @@ private slots:
     void onDeleteContactClicked();
     void onRefreshClicked();
     void onSearchTextChanged(const QString &text);
+    void onSearchResultsReady(const QString &searchTerm, const QVector<Contact> &contacts);
     void onTableSelectionChanged();
 
+    // Import slots
+    void onImportClicked();
+    void onImportProgress(qint64 bytesRead, qint64 totalBytes, int imported);
+    void onImportFinished(const ImportSummary &summary);
+
+    // Export slots
+    void onExportClicked();
+    void onExportProgress(int exported, int total);
+    void onExportFinished(const ExportSummary &summary);
+
+    // Duplicate detection
+    void onFindDuplicatesClicked();
+
+    // Facet filtering
+    void onFacetSelected(ContactFacet facet, const QString &value);
+
     // Network slots
     void onFetchFromApiClicked();
     void onContactFetched(const Contact &contact);
+    void onFetchBatchClicked();
+    void onBatchProgress(int fetched, int requested);
+    void onContactsFetched(const QVector<Contact> &contacts);
     void onNetworkFetchStarted();
     void onNetworkFetchFinished();
     void onNetworkError(const QString &error);
@@ -54,15 +90,38 @@ private:
     Ui::MainWindow *ui;
     DatabaseManager *m_dbManager;
     NetworkManager *m_networkManager;
+    ContactTableModel *m_contactModel;
+    ContactSearcher *m_searcher;
+    ContactImporter *m_importer;
+    ContactExporter *m_exporter;
+    FacetPanel *m_facetPanel;
+    DiagnosticsPanel *m_diagnosticsPanel;
+    // Only when CONTACTMANAGER_HTTP_PORT is set
+    ContactHttpServer *m_httpServer;
+    QProgressBar *m_progressBar;
+    // Start-up timing: first paint, then the live list replacing the snapshot
+    QElapsedTimer m_startupTimer;
+    bool m_firstPaintReported;
+    bool m_showingSnapshot;
     
+    void setupContactTable();
     void setupConnections();
     void loadContacts();
+    bool showSnapshot();
+    void saveSnapshot();
+    QString snapshotSource() const;
     void displayContacts(const QVector<Contact> &contacts);
+    void resizeColumnsFromSample();
+    int currentContactRow() const;
+    QVector<int> selectedContactIds() const;
+    void selectContact(const Contact &contact);
     void updateButtonStates();
     void showStatusMessage(const QString &message, int timeout = 3000);
     
     // Dialog helpers
     Contact showContactDialog(const QString &title, const Contact &contact = Contact());
+    void editSelectedContacts(const QVector<int> &ids);
+    void deleteSelectedContacts(const QVector<int> &ids);
 };
 
 /**
@@ -86,4 +145,32 @@ private:
     Contact m_contact;
 };
 
+/**
+ * @brief Dialog for setting fields on many contacts at once
+ *
+ * Only fields whose box is ticked end up in the patch.
+ */
+class BulkEditDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    BulkEditDialog(int contactCount, QWidget *parent = nullptr);
+    ContactPatch getPatch() const;
+
+private:
+    enum Field {
+        FirstNameField,
+        LastNameField,
+        EmailField,
+        PhoneField,
+        CityField,
+        CountryField,
+        FieldCount
+    };
+
+    QCheckBox *m_enabled[FieldCount];
+    QLineEdit *m_edits[FieldCount];
+};
+
 #endif // MAINWINDOW_H
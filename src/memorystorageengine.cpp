@@ -0,0 +1,892 @@
+#include "memorystorageengine.h"
+#include "contactnormalizer.h"
+#include <QDataStream>
+#include <QReadLocker>
+#include <QSaveFile>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Each log record is framed as [payload length][checksum][payload], the
+// payload being an entry count followed by that many entries
+constexpr int RecordHeaderSize = sizeof(quint32) + sizeof(quint16);
+// Anything larger is treated as a corrupt length field
+constexpr quint32 MaxRecordSize = 64 << 20;
+// Snapshots are written in records of this many inserts
+constexpr int SnapshotRecordEntries = 1024;
+// open() compacts once the log holds this many entries beyond twice the row count
+constexpr qint64 CompactionSlack = 1024;
+
+void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+bool syncFile(QFile &file)
+{
+#if defined(Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+bool MemoryStorageEngine::SortKey::operator<(const SortKey &other) const
+{
+    if (firstName != other.firstName) return firstName < other.firstName;
+    if (lastName != other.lastName) return lastName < other.lastName;
+    return id < other.id;
+}
+
+MemoryStorageEngine::MemoryStorageEngine(const QString &logPath)
+    : m_logPath(logPath)
+    , m_syncOnWrite(false)
+    , m_open(false)
+    , m_nextId(1)
+    , m_logEntries(0)
+{
+}
+
+MemoryStorageEngine::~MemoryStorageEngine()
+{
+    close();
+}
+
+// ============= Lifecycle =============
+
+bool MemoryStorageEngine::open(QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (m_open) return true;
+
+    if (!m_logPath.isEmpty()) {
+        m_log.setFileName(m_logPath);
+        if (!m_log.open(QIODevice::ReadWrite)) {
+            setError(error, "Failed to open log " + m_logPath + ": " + m_log.errorString());
+            return false;
+        }
+
+        if (!replayLog(error)) {
+            m_log.close();
+            m_contacts.clear();
+            m_order.clear();
+            m_tokens.clear();
+            m_emailIndex.clear();
+            m_phoneIndex.clear();
+            m_countryIndex.clear();
+            m_cityIndex.clear();
+            return false;
+        }
+
+        if (m_logEntries > 2 * m_contacts.size() + CompactionSlack) {
+            QString compactError;
+            if (!writeSnapshot(&compactError)) {
+                qWarning() << "MemoryStorageEngine: compaction failed:" << compactError;
+            }
+        }
+    }
+
+    m_open = true;
+    qDebug() << "In-memory store opened with" << m_contacts.size() << "contacts";
+    return true;
+}
+
+void MemoryStorageEngine::close()
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) return;
+
+    m_open = false;
+    m_log.close();
+    m_contacts.clear();
+    m_order.clear();
+    m_tokens.clear();
+    m_emailIndex.clear();
+    m_phoneIndex.clear();
+    m_countryIndex.clear();
+    m_cityIndex.clear();
+    m_nextId = 1;
+    m_logEntries = 0;
+}
+
+bool MemoryStorageEngine::isOpen() const
+{
+    QReadLocker locker(&m_lock);
+    return m_open;
+}
+
+bool MemoryStorageEngine::createSchema(QString *error)
+{
+    // Indexes are built as rows arrive; there is nothing to create
+    if (!isOpen()) {
+        setError(error, "Storage not open");
+        return false;
+    }
+    return true;
+}
+
+// ============= Indexes =============
+
+MemoryStorageEngine::SortKey MemoryStorageEngine::keyOf(const Contact &contact)
+{
+    return {contact.firstName, contact.lastName, contact.id};
+}
+
+QStringList MemoryStorageEngine::tokenize(const QString &text)
+{
+    // Same folding as FTS5's unicode61 tokenizer with remove_diacritics
+    return ContactNormalizer::tokens(text);
+}
+
+QStringList MemoryStorageEngine::tokensOf(const Contact &contact)
+{
+    QStringList tokens;
+    for (const QString *field : {&contact.firstName, &contact.lastName, &contact.email,
+                                 &contact.phone, &contact.city, &contact.country}) {
+        tokens += tokenize(*field);
+    }
+    tokens.removeDuplicates();
+    return tokens;
+}
+
+void MemoryStorageEngine::indexContact(const Contact &contact)
+{
+    m_order.insert(keyOf(contact));
+    for (const QString &token : tokensOf(contact)) {
+        m_tokens[token].insert(contact.id);
+    }
+
+    const QString email = ContactNormalizer::email(contact.email);
+    if (!email.isEmpty()) m_emailIndex.insert(email, contact.id);
+    const QString phone = ContactNormalizer::phone(contact.phone);
+    if (!phone.isEmpty()) m_phoneIndex.insert(phone, contact.id);
+
+    m_countryIndex[contact.country].insert(contact.id);
+    m_cityIndex[contact.city].insert(contact.id);
+}
+
+void MemoryStorageEngine::unindexContact(const Contact &contact)
+{
+    m_order.erase(keyOf(contact));
+    m_emailIndex.remove(ContactNormalizer::email(contact.email), contact.id);
+    m_phoneIndex.remove(ContactNormalizer::phone(contact.phone), contact.id);
+    for (const QString &token : tokensOf(contact)) {
+        auto it = m_tokens.find(token);
+        if (it == m_tokens.end()) continue;
+        it->second.remove(contact.id);
+        if (it->second.isEmpty()) m_tokens.erase(it);
+    }
+
+    auto unindexFacet = [&contact](QHash<QString, QSet<int>> &index, const QString &value) {
+        auto it = index.find(value);
+        if (it == index.end()) return;
+        it->remove(contact.id);
+        if (it->isEmpty()) index.erase(it);
+    };
+    unindexFacet(m_countryIndex, contact.country);
+    unindexFacet(m_cityIndex, contact.city);
+}
+
+void MemoryStorageEngine::applyInsert(const Contact &contact)
+{
+    auto existing = m_contacts.constFind(contact.id);
+    if (existing != m_contacts.constEnd()) {
+        unindexContact(*existing);
+    }
+    m_contacts.insert(contact.id, contact);
+    indexContact(contact);
+    m_nextId = qMax(m_nextId, contact.id + 1);
+}
+
+void MemoryStorageEngine::applyUpdate(const Contact &contact)
+{
+    auto it = m_contacts.find(contact.id);
+    if (it == m_contacts.end()) return;
+
+    unindexContact(*it);
+    *it = contact;
+    indexContact(contact);
+}
+
+void MemoryStorageEngine::applyRemove(int id)
+{
+    auto it = m_contacts.find(id);
+    if (it == m_contacts.end()) return;
+
+    unindexContact(*it);
+    m_contacts.erase(it);
+}
+
+// ============= Durability log =============
+
+QByteArray MemoryStorageEngine::encodeEntry(LogOp op, const Contact &contact)
+{
+    QByteArray entry;
+    QDataStream stream(&entry, QIODevice::WriteOnly);
+    stream << quint8(op) << qint32(contact.id);
+    if (op != LogRemove) {
+        stream << contact.firstName << contact.lastName << contact.email
+               << contact.phone << contact.city << contact.country;
+    }
+    return entry;
+}
+
+QByteArray MemoryStorageEngine::frameRecord(const QByteArray &entries, int count)
+{
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream << quint32(count);
+    }
+    payload.append(entries);
+
+    QByteArray record;
+    {
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream << quint32(payload.size()) << qChecksum(payload);
+    }
+    record.append(payload);
+    return record;
+}
+
+bool MemoryStorageEngine::replayLog(QString *error)
+{
+    m_logEntries = 0;
+    qint64 goodOffset = 0;
+
+    while (!m_log.atEnd()) {
+        const QByteArray header = m_log.read(RecordHeaderSize);
+        if (header.size() < RecordHeaderSize) break;
+
+        quint32 length;
+        quint16 checksum;
+        QDataStream headerStream(header);
+        headerStream >> length >> checksum;
+        if (length > MaxRecordSize) break;
+
+        const QByteArray payload = m_log.read(length);
+        if (payload.size() < int(length) || qChecksum(payload) != checksum) break;
+
+        // Decode the whole record before applying any of it
+        QDataStream stream(payload);
+        quint32 count;
+        stream >> count;
+        QVector<QPair<quint8, Contact>> entries;
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            quint8 op;
+            qint32 id;
+            Contact contact;
+            stream >> op >> id;
+            contact.id = id;
+            if (op != LogRemove) {
+                stream >> contact.firstName >> contact.lastName >> contact.email
+                       >> contact.phone >> contact.city >> contact.country;
+            }
+            entries.append({op, contact});
+        }
+        if (stream.status() != QDataStream::Ok) break;
+
+        for (const auto &entry : std::as_const(entries)) {
+            switch (entry.first) {
+            case LogInsert: applyInsert(entry.second); break;
+            case LogUpdate: applyUpdate(entry.second); break;
+            case LogRemove: applyRemove(entry.second.id); break;
+            default:
+                setError(error, QString("Unknown entry type %1 in %2").arg(entry.first).arg(m_logPath));
+                return false;
+            }
+        }
+
+        m_logEntries += count;
+        goodOffset = m_log.pos();
+    }
+
+    if (goodOffset < m_log.size()) {
+        // Torn write from a crash; later appends must start on a record boundary
+        qWarning() << "MemoryStorageEngine: dropping" << m_log.size() - goodOffset
+                   << "trailing bytes of" << m_logPath;
+        if (!m_log.resize(goodOffset)) {
+            setError(error, "Failed to truncate log: " + m_log.errorString());
+            return false;
+        }
+    }
+
+    m_log.seek(goodOffset);
+    return true;
+}
+
+bool MemoryStorageEngine::appendEntries(const QByteArray &entries, int count, QString *error)
+{
+    if (!m_log.isOpen()) return true;
+
+    // One record per call, so replay applies the whole group or none of it
+    const QByteArray record = frameRecord(entries, count);
+    const qint64 start = m_log.pos();
+    bool ok = m_log.write(record) == record.size() && m_log.flush();
+    if (ok && m_syncOnWrite) {
+        ok = syncFile(m_log);
+    }
+
+    if (!ok) {
+        setError(error, "Failed to write log: " + m_log.errorString());
+        // Keep the log in step with memory, which has not changed
+        m_log.resize(start);
+        m_log.seek(start);
+        return false;
+    }
+
+    m_logEntries += count;
+    return true;
+}
+
+bool MemoryStorageEngine::writeSnapshot(QString *error)
+{
+    QSaveFile snapshot(m_logPath);
+    if (!snapshot.open(QIODevice::WriteOnly)) {
+        setError(error, "Failed to write snapshot: " + snapshot.errorString());
+        return false;
+    }
+
+    QByteArray entries;
+    int count = 0;
+    for (const SortKey &key : m_order) {
+        entries.append(encodeEntry(LogInsert, m_contacts.value(key.id)));
+        if (++count == SnapshotRecordEntries) {
+            snapshot.write(frameRecord(entries, count));
+            entries.clear();
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        snapshot.write(frameRecord(entries, count));
+    }
+
+    if (!snapshot.commit()) {
+        setError(error, "Failed to replace log: " + snapshot.errorString());
+        return false;
+    }
+
+    // The old handle points at the replaced file
+    m_log.close();
+    if (!m_log.open(QIODevice::ReadWrite)) {
+        setError(error, "Failed to reopen log: " + m_log.errorString());
+        return false;
+    }
+    m_log.seek(m_log.size());
+    m_logEntries = m_contacts.size();
+    return true;
+}
+
+bool MemoryStorageEngine::compact(QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open || m_logPath.isEmpty()) return true;
+    return writeSnapshot(error);
+}
+
+// ============= Writes =============
+
+bool MemoryStorageEngine::insert(Contact *contact, QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    Contact stored = *contact;
+    stored.id = m_nextId;
+    if (!appendEntries(encodeEntry(LogInsert, stored), 1, error)) {
+        return false;
+    }
+
+    applyInsert(stored);
+    contact->id = stored.id;
+    return true;
+}
+
+int MemoryStorageEngine::insertBatch(const QVector<Contact> &contacts, QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return -1;
+    }
+
+    QVector<Contact> stored;
+    stored.reserve(contacts.size());
+    QByteArray entries;
+    int nextId = m_nextId;
+    for (const Contact &contact : contacts) {
+        if (!contact.isValid()) continue;
+
+        stored.append(contact);
+        stored.last().id = nextId++;
+        entries.append(encodeEntry(LogInsert, stored.last()));
+    }
+
+    // One write for the whole batch; nothing is applied unless it lands
+    if (!appendEntries(entries, stored.size(), error)) {
+        return -1;
+    }
+
+    for (const Contact &contact : stored) {
+        applyInsert(contact);
+    }
+    return stored.size();
+}
+
+bool MemoryStorageEngine::update(const Contact &contact, QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    if (!m_contacts.contains(contact.id)) {
+        setError(error, "Contact not found");
+        return false;
+    }
+
+    if (!appendEntries(encodeEntry(LogUpdate, contact), 1, error)) {
+        return false;
+    }
+
+    applyUpdate(contact);
+    return true;
+}
+
+bool MemoryStorageEngine::remove(int id, QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    if (!m_contacts.contains(id)) {
+        return true;
+    }
+
+    Contact removed;
+    removed.id = id;
+    if (!appendEntries(encodeEntry(LogRemove, removed), 1, error)) {
+        return false;
+    }
+
+    applyRemove(id);
+    return true;
+}
+
+bool MemoryStorageEngine::merge(const Contact &survivor, const QVector<int> &removedIds,
+                                QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    if (!m_contacts.contains(survivor.id)) {
+        setError(error, "Contact not found");
+        return false;
+    }
+
+    // Logged as one record, so a crash keeps either all of it or none
+    QByteArray entries = encodeEntry(LogUpdate, survivor);
+    Contact removed;
+    for (int id : removedIds) {
+        removed.id = id;
+        entries.append(encodeEntry(LogRemove, removed));
+    }
+    if (!appendEntries(entries, 1 + removedIds.size(), error)) {
+        return false;
+    }
+
+    applyUpdate(survivor);
+    for (int id : removedIds) {
+        applyRemove(id);
+    }
+    return true;
+}
+
+QVector<Contact> MemoryStorageEngine::existingContacts(const QVector<int> &ids) const
+{
+    QVector<Contact> contacts;
+    QSet<int> seen;
+    for (int id : ids) {
+        auto it = m_contacts.constFind(id);
+        if (it == m_contacts.constEnd() || seen.contains(id)) continue;
+        seen.insert(id);
+        contacts.append(*it);
+    }
+    std::sort(contacts.begin(), contacts.end(), [](const Contact &a, const Contact &b) {
+        return keyOf(a) < keyOf(b);
+    });
+    return contacts;
+}
+
+bool MemoryStorageEngine::removeMany(const QVector<int> &ids, QVector<Contact> *removed,
+                                     QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    const QVector<Contact> rows = existingContacts(ids);
+    QByteArray entries;
+    for (const Contact &contact : rows) {
+        entries.append(encodeEntry(LogRemove, contact));
+    }
+    if (!rows.isEmpty() && !appendEntries(entries, rows.size(), error)) {
+        return false;
+    }
+
+    for (const Contact &contact : rows) {
+        applyRemove(contact.id);
+    }
+    *removed = rows;
+    return true;
+}
+
+bool MemoryStorageEngine::updateMany(const QVector<int> &ids, const ContactPatch &patch,
+                                     QVector<Contact> *previous, QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    const QVector<Contact> rows = existingContacts(ids);
+    QVector<Contact> updated = rows;
+    QByteArray entries;
+    for (Contact &contact : updated) {
+        patch.applyTo(&contact);
+        entries.append(encodeEntry(LogUpdate, contact));
+    }
+    if (!rows.isEmpty() && !patch.isEmpty() && !appendEntries(entries, rows.size(), error)) {
+        return false;
+    }
+
+    if (!patch.isEmpty()) {
+        for (const Contact &contact : std::as_const(updated)) {
+            applyUpdate(contact);
+        }
+    }
+    *previous = rows;
+    return true;
+}
+
+bool MemoryStorageEngine::applyWrites(QVector<ContactWrite> *writes, QString *error)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    // Resolve every write against the state left by the ones before it,
+    // then log the batch as one record and only apply it once that lands
+    QHash<int, Contact> staged;   // id -1 marks a row removed earlier in the batch
+    auto current = [&](int id, Contact *contact) {
+        auto it = staged.constFind(id);
+        if (it != staged.constEnd()) {
+            if (it->id < 0) return false;
+            *contact = *it;
+            return true;
+        }
+        auto stored = m_contacts.constFind(id);
+        if (stored == m_contacts.constEnd()) return false;
+        *contact = *stored;
+        return true;
+    };
+
+    QByteArray entries;
+    int entryCount = 0;
+    int nextId = m_nextId;
+    for (ContactWrite &write : *writes) {
+        write.applied = false;
+
+        if (write.kind == ContactWrite::Insert) {
+            write.contact.id = nextId++;
+            entries.append(encodeEntry(LogInsert, write.contact));
+            staged.insert(write.contact.id, write.contact);
+        } else {
+            if (!current(write.contact.id, &write.previous)) continue;
+
+            if (write.kind == ContactWrite::Update) {
+                entries.append(encodeEntry(LogUpdate, write.contact));
+                staged.insert(write.contact.id, write.contact);
+            } else {
+                entries.append(encodeEntry(LogRemove, write.contact));
+                Contact removed;
+                staged.insert(write.contact.id, removed);
+            }
+        }
+        write.applied = true;
+        ++entryCount;
+    }
+
+    if (entryCount > 0 && !appendEntries(entries, entryCount, error)) {
+        for (ContactWrite &write : *writes) {
+            write.applied = false;
+        }
+        return false;
+    }
+
+    for (const ContactWrite &write : std::as_const(*writes)) {
+        if (!write.applied) continue;
+        switch (write.kind) {
+        case ContactWrite::Insert: applyInsert(write.contact); break;
+        case ContactWrite::Update: applyUpdate(write.contact); break;
+        case ContactWrite::Remove: applyRemove(write.contact.id); break;
+        }
+    }
+    return true;
+}
+
+// ============= Reads =============
+
+bool MemoryStorageEngine::get(int id, Contact *contact, QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    auto it = m_contacts.constFind(id);
+    if (it == m_contacts.constEnd()) {
+        return false;
+    }
+
+    *contact = *it;
+    return true;
+}
+
+bool MemoryStorageEngine::getAll(QVector<Contact> *contacts, QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    contacts->reserve(contacts->size() + m_contacts.size());
+    for (const SortKey &key : m_order) {
+        contacts->append(m_contacts.value(key.id));
+    }
+    return true;
+}
+
+int MemoryStorageEngine::count(QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return -1;
+    }
+    return m_contacts.size();
+}
+
+bool MemoryStorageEngine::page(const Contact &after, int limit, QVector<Contact> *contacts,
+                               QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    auto it = after.id < 0 ? m_order.begin() : m_order.upper_bound(keyOf(after));
+    contacts->reserve(contacts->size() + limit);
+    for (int rows = 0; it != m_order.end() && rows < limit; ++it, ++rows) {
+        contacts->append(m_contacts.value(it->id));
+    }
+    return true;
+}
+
+bool MemoryStorageEngine::search(const QString &searchTerm, int limit, QVector<Contact> *contacts,
+                                 QString *error, const std::function<bool()> &isCancelled)
+{
+    const QStringList queryTokens = tokenize(searchTerm);
+    if (queryTokens.isEmpty()) {
+        return true;
+    }
+
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    // Every query token must prefix-match some token of the contact
+    QSet<int> candidates;
+    for (int i = 0; i < queryTokens.size(); ++i) {
+        const QString &prefix = queryTokens.at(i);
+        QSet<int> matches;
+        for (auto it = m_tokens.lower_bound(prefix);
+             it != m_tokens.end() && it->first.startsWith(prefix); ++it) {
+            matches.unite(it->second);
+        }
+
+        if (i == 0) {
+            candidates = std::move(matches);
+        } else {
+            candidates.intersect(matches);
+        }
+        if (candidates.isEmpty() || (isCancelled && isCancelled())) {
+            return true;
+        }
+    }
+
+    // Name matches rank first, like FTS5's bm25 on short name columns
+    struct Ranked {
+        int score;
+        SortKey key;
+    };
+    QVector<Ranked> ranked;
+    ranked.reserve(candidates.size());
+    int rows = 0;
+    for (int id : std::as_const(candidates)) {
+        if (isCancelled && (++rows % 256) == 0 && isCancelled()) {
+            return true;
+        }
+
+        const Contact &contact = *m_contacts.constFind(id);
+        const QStringList nameTokens = tokenize(contact.firstName) + tokenize(contact.lastName);
+        int score = 0;
+        for (const QString &prefix : queryTokens) {
+            for (const QString &token : nameTokens) {
+                if (token.startsWith(prefix)) {
+                    ++score;
+                    break;
+                }
+            }
+        }
+        ranked.append({score, keyOf(contact)});
+    }
+
+    std::sort(ranked.begin(), ranked.end(), [](const Ranked &a, const Ranked &b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.key < b.key;
+    });
+
+    const int count = limit < 0 ? ranked.size() : qMin(limit, int(ranked.size()));
+    contacts->reserve(contacts->size() + count);
+    for (int i = 0; i < count; ++i) {
+        contacts->append(m_contacts.value(ranked.at(i).key.id));
+    }
+    return true;
+}
+
+bool MemoryStorageEngine::findByKeys(const QMultiHash<QString, int> &index, const QStringList &keys,
+                                     QVector<Contact> *contacts, QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    for (const QString &key : keys) {
+        for (auto it = index.constFind(key); it != index.constEnd() && it.key() == key; ++it) {
+            contacts->append(m_contacts.value(it.value()));
+        }
+    }
+    return true;
+}
+
+bool MemoryStorageEngine::findByEmail(const QStringList &emails, QVector<Contact> *contacts,
+                                      QString *error)
+{
+    QStringList keys;
+    for (const QString &email : emails) {
+        const QString key = ContactNormalizer::email(email);
+        if (!key.isEmpty()) keys.append(key);
+    }
+    keys.removeDuplicates();
+    return findByKeys(m_emailIndex, keys, contacts, error);
+}
+
+bool MemoryStorageEngine::findByPhone(const QStringList &phones, QVector<Contact> *contacts,
+                                      QString *error)
+{
+    QStringList keys;
+    for (const QString &phone : phones) {
+        const QString key = ContactNormalizer::phone(phone);
+        if (!key.isEmpty()) keys.append(key);
+    }
+    keys.removeDuplicates();
+    return findByKeys(m_phoneIndex, keys, contacts, error);
+}
+
+// ============= Facets =============
+
+bool MemoryStorageEngine::facetCounts(ContactFacet facet, QVector<FacetCount> *counts,
+                                      QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    const QHash<QString, QSet<int>> &index = facet == CountryFacet ? m_countryIndex : m_cityIndex;
+    counts->reserve(counts->size() + index.size());
+    for (auto it = index.cbegin(); it != index.cend(); ++it) {
+        FacetCount count;
+        count.value = it.key();
+        count.count = it->size();
+        counts->append(count);
+    }
+    std::sort(counts->begin(), counts->end(), [](const FacetCount &a, const FacetCount &b) {
+        if (a.count != b.count) return a.count > b.count;
+        return a.value < b.value;
+    });
+    return true;
+}
+
+bool MemoryStorageEngine::findByFacet(ContactFacet facet, const QString &value, int limit,
+                                      QVector<Contact> *contacts, QString *error)
+{
+    QReadLocker locker(&m_lock);
+    if (!m_open) {
+        setError(error, "Storage not open");
+        return false;
+    }
+
+    const QHash<QString, QSet<int>> &index = facet == CountryFacet ? m_countryIndex : m_cityIndex;
+    auto it = index.constFind(value);
+    if (it == index.constEnd()) return true;
+
+    std::vector<SortKey> keys;
+    keys.reserve(it->size());
+    for (int id : *it) {
+        keys.push_back(keyOf(*m_contacts.constFind(id)));
+    }
+
+    const size_t count = limit < 0 ? keys.size() : qMin(keys.size(), size_t(limit));
+    std::partial_sort(keys.begin(), keys.begin() + count, keys.end());
+    contacts->reserve(contacts->size() + int(count));
+    for (size_t i = 0; i < count; ++i) {
+        contacts->append(*m_contacts.constFind(keys[i].id));
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef MEMORYSTORAGEENGINE_H
+#define MEMORYSTORAGEENGINE_H
+
+#include <QFile>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <map>
+#include <set>
+#include "storageengine.h"
+
+/**
+ * @brief StorageEngine that keeps every contact in RAM
+ *
+ * Rows live in a hash keyed by id, with a sorted index over
+ * (first_name, last_name, id) for ordered reads and keyset pages, an
+ * ordered token index for prefix search, hashes of the normalized
+ * email and phone for exact lookups and per-value id sets for the
+ * country and city facets. Nothing touches disk unless a
+ * log path is given: then every mutation is appended to that file before
+ * it is applied, and open() rebuilds the state by replaying it. Each
+ * call (a batch insert, a merge) is one checksummed record, and a torn
+ * record at the end of the log (from a crash mid-write) is dropped. When
+ * the log holds far more entries than live rows, open() rewrites it as a
+ * snapshot. Without a log, close() discards every row.
+ *
+ * Readers share a lock, writers take it exclusively, so every method is
+ * safe to call from any thread.
+ */
+class MemoryStorageEngine : public StorageEngine
+{
+public:
+    // An empty logPath keeps the engine purely in memory
+    explicit MemoryStorageEngine(const QString &logPath = QString());
+    ~MemoryStorageEngine() override;
+
+    QString name() const override { return QStringLiteral("memory"); }
+    QString logPath() const { return m_logPath; }
+
+    // fsync after every logged mutation instead of only flushing to the OS
+    void setSyncOnWrite(bool sync) { m_syncOnWrite = sync; }
+    bool syncOnWrite() const { return m_syncOnWrite; }
+
+    // Nothing here is bound to a thread, so the whole open (log replay
+    // included) happens in prepare(); open() afterwards returns at once
+    bool prepare(QString *error = nullptr) override { return open(error); }
+    bool open(QString *error = nullptr) override;
+    void close() override;
+    bool isOpen() const override;
+    bool createSchema(QString *error = nullptr) override;
+
+    bool insert(Contact *contact, QString *error = nullptr) override;
+    int insertBatch(const QVector<Contact> &contacts, QString *error = nullptr) override;
+    bool update(const Contact &contact, QString *error = nullptr) override;
+    bool remove(int id, QString *error = nullptr) override;
+    bool merge(const Contact &survivor, const QVector<int> &removedIds,
+               QString *error = nullptr) override;
+    bool removeMany(const QVector<int> &ids, QVector<Contact> *removed,
+                    QString *error = nullptr) override;
+    bool updateMany(const QVector<int> &ids, const ContactPatch &patch,
+                    QVector<Contact> *previous, QString *error = nullptr) override;
+    bool applyWrites(QVector<ContactWrite> *writes, QString *error = nullptr) override;
+
+    bool get(int id, Contact *contact, QString *error = nullptr) override;
+    bool getAll(QVector<Contact> *contacts, QString *error = nullptr) override;
+    int count(QString *error = nullptr) override;
+    bool page(const Contact &after, int limit, QVector<Contact> *contacts,
+              QString *error = nullptr) override;
+    bool search(const QString &searchTerm, int limit, QVector<Contact> *contacts,
+                QString *error = nullptr,
+                const std::function<bool()> &isCancelled = {}) override;
+    bool findByEmail(const QStringList &emails, QVector<Contact> *contacts,
+                     QString *error = nullptr) override;
+    bool findByPhone(const QStringList &phones, QVector<Contact> *contacts,
+                     QString *error = nullptr) override;
+    bool facetCounts(ContactFacet facet, QVector<FacetCount> *counts,
+                     QString *error = nullptr) override;
+    bool findByFacet(ContactFacet facet, const QString &value, int limit,
+                     QVector<Contact> *contacts, QString *error = nullptr) override;
+
+    // Rewrites the log as one insert per live row
+    bool compact(QString *error = nullptr) override;
+
+private:
+    enum LogOp : quint8 {
+        LogInsert = 1,
+        LogUpdate = 2,
+        LogRemove = 3
+    };
+
+    struct SortKey {
+        QString firstName;
+        QString lastName;
+        int id;
+
+        bool operator<(const SortKey &other) const;
+    };
+
+    QString m_logPath;
+    bool m_syncOnWrite;
+    bool m_open;
+    mutable QReadWriteLock m_lock;
+
+    QHash<int, Contact> m_contacts;
+    std::set<SortKey> m_order;
+    // Folded token -> ids of the contacts containing it
+    std::map<QString, QSet<int>> m_tokens;
+    // Normalized email / phone -> ids, for exact lookups
+    QMultiHash<QString, int> m_emailIndex;
+    QMultiHash<QString, int> m_phoneIndex;
+    // Country / city -> ids; the set sizes are the facet counts
+    QHash<QString, QSet<int>> m_countryIndex;
+    QHash<QString, QSet<int>> m_cityIndex;
+    int m_nextId;
+
+    QFile m_log;
+    qint64 m_logEntries;
+
+    static SortKey keyOf(const Contact &contact);
+    static QStringList tokenize(const QString &text);
+    static QStringList tokensOf(const Contact &contact);
+
+    // Existing contacts among ids, without duplicates, in sort order
+    QVector<Contact> existingContacts(const QVector<int> &ids) const;
+    bool findByKeys(const QMultiHash<QString, int> &index, const QStringList &keys,
+                    QVector<Contact> *contacts, QString *error);
+    void indexContact(const Contact &contact);
+    void unindexContact(const Contact &contact);
+    void applyInsert(const Contact &contact);
+    void applyUpdate(const Contact &contact);
+    void applyRemove(int id);
+
+    bool replayLog(QString *error);
+    static QByteArray encodeEntry(LogOp op, const Contact &contact);
+    static QByteArray frameRecord(const QByteArray &entries, int count);
+    bool appendEntries(const QByteArray &entries, int count, QString *error);
+    bool writeSnapshot(QString *error);
+};
+
+#endif // MEMORYSTORAGEENGINE_H
@@ -0,0 +1,219 @@
+#include "nativecontactreader.h"
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+
+#ifdef CONTACTMANAGER_HAVE_SQLITE3
+#include <sqlite3.h>
+
+namespace {
+
+// Column order shared by every SELECT below, read back by position
+#define CONTACT_COLUMNS "id, first_name, last_name, email, phone, city, country"
+
+const char *const StatementSql[] = {
+    "SELECT " CONTACT_COLUMNS " FROM contacts WHERE id = ?1",
+    "SELECT " CONTACT_COLUMNS " FROM contacts ORDER BY first_name, last_name, id",
+    "SELECT " CONTACT_COLUMNS " FROM contacts ORDER BY first_name, last_name, id LIMIT ?1",
+    "SELECT " CONTACT_COLUMNS " FROM contacts "
+    "WHERE (first_name, last_name, id) > (?1, ?2, ?3) "
+    "ORDER BY first_name, last_name, id LIMIT ?4"
+};
+
+#undef CONTACT_COLUMNS
+
+} // namespace
+#endif
+
+NativeContactReader::NativeContactReader()
+    : m_db(nullptr), m_utf16(false)
+{
+    for (sqlite3_stmt *&stmt : m_statements) stmt = nullptr;
+}
+
+NativeContactReader::~NativeContactReader()
+{
+    close();
+}
+
+bool NativeContactReader::isAvailable()
+{
+#ifdef CONTACTMANAGER_HAVE_SQLITE3
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef CONTACTMANAGER_HAVE_SQLITE3
+
+bool NativeContactReader::open(const QSqlDatabase &database)
+{
+    close();
+
+    // The driver exposes its connection as a QVariant holding sqlite3*
+    const QVariant handle = database.isOpen() ? database.driver()->handle() : QVariant();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0) {
+        m_lastError = "Not an open QSQLITE connection";
+        return false;
+    }
+    m_db = *static_cast<sqlite3 *const *>(handle.constData());
+    if (!m_db) {
+        m_lastError = "QSQLITE connection has no handle";
+        return false;
+    }
+
+    // Text columns are extracted in the database's native encoding
+    sqlite3_stmt *encoding = nullptr;
+    if (sqlite3_prepare_v2(m_db, "PRAGMA encoding", -1, &encoding, nullptr) == SQLITE_OK
+        && sqlite3_step(encoding) == SQLITE_ROW) {
+        const char *name = reinterpret_cast<const char *>(sqlite3_column_text(encoding, 0));
+        m_utf16 = name && qstrncmp(name, "UTF-16", 6) == 0;
+    }
+    sqlite3_finalize(encoding);
+
+    m_lastError.clear();
+    return true;
+}
+
+void NativeContactReader::close()
+{
+    for (sqlite3_stmt *&stmt : m_statements) {
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+    }
+    // The handle belongs to the QSQLITE connection
+    m_db = nullptr;
+}
+
+bool NativeContactReader::readContact(int id, Contact *contact)
+{
+    m_lastError.clear();
+    sqlite3_stmt *stmt = statement(SelectById);
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt, 1, id);
+    int rc = sqlite3_step(stmt);
+    bool found = rc == SQLITE_ROW;
+    if (found) {
+        readRow(stmt, contact);
+    } else if (rc != SQLITE_DONE) {
+        setError("Failed to read contact");
+    }
+    sqlite3_reset(stmt);
+    return found;
+}
+
+bool NativeContactReader::readAll(QVector<Contact> *contacts)
+{
+    sqlite3_stmt *stmt = statement(SelectAll);
+    return stmt && step(stmt, contacts);
+}
+
+bool NativeContactReader::readPage(const Contact &after, int limit, QVector<Contact> *contacts)
+{
+    sqlite3_stmt *stmt = nullptr;
+    if (after.id < 0) {
+        stmt = statement(SelectFirstPage);
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, limit);
+    } else {
+        stmt = statement(SelectPageAfter);
+        if (!stmt) return false;
+        // SQLITE_TRANSIENT: the QString buffers don't outlive this call
+        sqlite3_bind_text16(stmt, 1, after.firstName.utf16(),
+                            int(after.firstName.size() * sizeof(QChar)), SQLITE_TRANSIENT);
+        sqlite3_bind_text16(stmt, 2, after.lastName.utf16(),
+                            int(after.lastName.size() * sizeof(QChar)), SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, after.id);
+        sqlite3_bind_int(stmt, 4, limit);
+    }
+
+    contacts->reserve(contacts->size() + limit);
+    return step(stmt, contacts);
+}
+
+sqlite3_stmt *NativeContactReader::statement(Statement which)
+{
+    if (!m_db) {
+        m_lastError = "Native reader not open";
+        return nullptr;
+    }
+
+    // Prepared lazily so the reader can be opened before the schema exists
+    sqlite3_stmt *&stmt = m_statements[which];
+    if (!stmt) {
+        if (sqlite3_prepare_v3(m_db, StatementSql[which], -1, SQLITE_PREPARE_PERSISTENT,
+                               &stmt, nullptr) != SQLITE_OK) {
+            setError("Failed to prepare statement");
+            stmt = nullptr;
+        }
+    }
+    return stmt;
+}
+
+bool NativeContactReader::step(sqlite3_stmt *stmt, QVector<Contact> *contacts)
+{
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        contacts->append(Contact());
+        readRow(stmt, &contacts->last());
+    }
+
+    bool ok = rc == SQLITE_DONE;
+    if (!ok) {
+        setError("Failed to read contacts");
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return ok;
+}
+
+void NativeContactReader::readRow(sqlite3_stmt *stmt, Contact *contact) const
+{
+    contact->id = sqlite3_column_int(stmt, 0);
+    contact->firstName = text(stmt, 1);
+    contact->lastName = text(stmt, 2);
+    contact->email = text(stmt, 3);
+    contact->phone = text(stmt, 4);
+    contact->city = text(stmt, 5);
+    contact->country = text(stmt, 6);
+}
+
+QString NativeContactReader::text(sqlite3_stmt *stmt, int column) const
+{
+    // Fetch the pointer first, then the byte count (per the sqlite3 docs)
+    if (m_utf16) {
+        const void *data = sqlite3_column_text16(stmt, column);
+        if (!data) return QString();
+        int bytes = sqlite3_column_bytes16(stmt, column);
+        return QString(reinterpret_cast<const QChar *>(data), bytes / int(sizeof(QChar)));
+    }
+
+    const unsigned char *data = sqlite3_column_text(stmt, column);
+    if (!data) return QString();
+    int bytes = sqlite3_column_bytes(stmt, column);
+    return QString::fromUtf8(reinterpret_cast<const char *>(data), bytes);
+}
+
+void NativeContactReader::setError(const QString &context)
+{
+    m_lastError = context + ": " + (m_db ? QString::fromUtf8(sqlite3_errmsg(m_db))
+                                         : QString("out of memory"));
+    qWarning() << "NativeContactReader Error:" << m_lastError;
+}
+
+#else // !CONTACTMANAGER_HAVE_SQLITE3
+
+bool NativeContactReader::open(const QSqlDatabase &)
+{
+    m_lastError = "Built without the sqlite3 C API";
+    return false;
+}
+
+void NativeContactReader::close() {}
+bool NativeContactReader::readContact(int, Contact *) { return false; }
+bool NativeContactReader::readAll(QVector<Contact> *) { return false; }
+bool NativeContactReader::readPage(const Contact &, int, QVector<Contact> *) { return false; }
+
+#endif // CONTACTMANAGER_HAVE_SQLITE3
@@ -0,0 +1,72 @@
+#ifndef NATIVECONTACTREADER_H
+#define NATIVECONTACTREADER_H
+
+#include <QString>
+#include <QVector>
+#include "contact.h"
+
+class QSqlDatabase;
+struct sqlite3;
+struct sqlite3_stmt;
+
+/**
+ * @brief Read-only row hydration straight through the sqlite3 C API
+ *
+ * Borrows the sqlite3 handle of an open QSQLITE connection, so the file
+ * is only ever opened by one SQLite library, and keeps one prepared
+ * statement per query until close(), which must come before the
+ * connection is closed. Columns are
+ * read by position and text goes from SQLite's buffer straight into the
+ * QString: UTF-16 databases are copied as-is, UTF-8 ones are decoded in
+ * a single pass, with no QVariant boxing or name lookup in between.
+ *
+ * Only available when built with CONTACTMANAGER_HAVE_SQLITE3, which the
+ * build only allows when Qt's SQLite driver uses the same system library;
+ * otherwise open() always fails and DatabaseManager stays on the QtSql
+ * path.
+ * Not thread-safe: use one instance per thread.
+ */
+class NativeContactReader
+{
+public:
+    NativeContactReader();
+    ~NativeContactReader();
+
+    NativeContactReader(const NativeContactReader &) = delete;
+    NativeContactReader &operator=(const NativeContactReader &) = delete;
+
+    static bool isAvailable();
+
+    bool open(const QSqlDatabase &database);
+    void close();
+    bool isOpen() const { return m_db != nullptr; }
+    QString lastError() const { return m_lastError; }
+
+    // Returns false if the row does not exist or on error; only an error
+    // sets lastError()
+    bool readContact(int id, Contact *contact);
+    bool readAll(QVector<Contact> *contacts);
+    bool readPage(const Contact &after, int limit, QVector<Contact> *contacts);
+
+private:
+    enum Statement {
+        SelectById,
+        SelectAll,
+        SelectFirstPage,
+        SelectPageAfter,
+        StatementCount
+    };
+
+    sqlite3 *m_db;
+    sqlite3_stmt *m_statements[StatementCount];
+    bool m_utf16;
+    QString m_lastError;
+
+    sqlite3_stmt *statement(Statement which);
+    bool step(sqlite3_stmt *stmt, QVector<Contact> *contacts);
+    void readRow(sqlite3_stmt *stmt, Contact *contact) const;
+    QString text(sqlite3_stmt *stmt, int column) const;
+    void setError(const QString &context);
+};
+
+#endif // NATIVECONTACTREADER_H
@@ -1,14 +1,17 @@
 #include "networkmanager.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include "logging.h"
 #include <QNetworkRequest>
-#include <QUrl>
+#include <QUrlQuery>
 #include <QDebug>
 
 NetworkManager::NetworkManager(QObject *parent)
-    : QObject(parent), m_busy(false)
+    : QObject(parent)
+    , m_baseUrl(defaultBaseUrl())
+    , m_activeRequests(0)
+    , m_metrics({"fetchRandomContact", "fetchContactBatch"})
 {
+    Q_ASSERT(m_metrics.operations().size() == OperationCount);
+    m_clock.start();
     m_networkManager = new QNetworkAccessManager(this);
     connect(m_networkManager, &QNetworkAccessManager::finished,
             this, &NetworkManager::onReplyFinished);
@@ -19,112 +22,177 @@ NetworkManager::~NetworkManager()
     // QNetworkAccessManager is deleted automatically as it's a child object
 }
 
+QUrl NetworkManager::defaultBaseUrl()
+{
+    // Tests point this at a local mock server
+    const QString url = qEnvironmentVariable("CONTACTMANAGER_API_URL");
+    return QUrl(url.isEmpty() ? QStringLiteral("https://randomuser.me/api/") : url);
+}
+
 void NetworkManager::fetchRandomContact()
 {
-    if (m_busy) {
-        qWarning() << "Network request already in progress";
+    sendRequest(FetchRandomContactOp, 1);
+}
+
+void NetworkManager::fetchRandomContacts(int count)
+{
+    if (count <= 0) return;
+    if (isBatchRunning()) {
+        qCWarning(lcNetwork) << "A batch fetch is already in progress";
         return;
     }
 
-    m_busy = true;
-    emit fetchStarted();
+    m_batch = Batch();
+    m_batch.requested = count;
+    m_batch.unrequested = count;
+    m_batch.contacts.reserve(count);
 
-    // Using RandomUser.me API - a free API for generating random user data
-    QUrl url("https://randomuser.me/api/?results=1");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-    qDebug() << "Fetching random contact from API...";
-    m_networkManager->get(request);
+    qCInfo(lcNetwork) << "Fetching" << count << "contacts from" << m_baseUrl.toString();
+    issueBatchRequests();
 }
 
-void NetworkManager::onReplyFinished(QNetworkReply *reply)
+void NetworkManager::sendRequest(Operation operation, int results)
 {
-    m_busy = false;
-    emit fetchFinished();
-
-    // Check for network errors
-    if (reply->error() != QNetworkReply::NoError) {
-        QString errorMsg = "Network error: " + reply->errorString();
-        qWarning() << errorMsg;
-        emit errorOccurred(errorMsg);
-        reply->deleteLater();
-        return;
+    if (m_activeRequests++ == 0) {
+        emit fetchStarted();
     }
 
-    // Read response data
-    QByteArray responseData = reply->readAll();
-    reply->deleteLater();
+    // Only the fields a Contact keeps, which trims each result to a third
+    QUrl url(m_baseUrl);
+    QUrlQuery query(url);
+    query.addQueryItem("results", QString::number(results));
+    query.addQueryItem("inc", "name,email,phone,location");
+    query.addQueryItem("noinfo", QString());
+    url.setQuery(query);
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    qCDebug(lcNetwork) << "Requesting" << results << "contacts from API...";
+    QNetworkReply *reply = m_networkManager->get(request);
+    reply->setProperty("operation", int(operation));
+    reply->setProperty("startedNs", m_clock.nsecsElapsed());
 
-    // Parse JSON and extract contact
-    Contact contact = parseJsonResponse(responseData);
-    
-    if (contact.isValid()) {
-        qDebug() << "Successfully fetched contact:" << contact.fullName();
-        emit contactFetched(contact);
+    // A single fetch hands over its contact at once; batch contacts are
+    // collected for the bulk insert
+    std::function<void(const Contact &)> onContact;
+    if (operation == FetchContactBatchOp) {
+        onContact = [this](const Contact &contact) { m_batch.contacts.append(contact); };
     } else {
-        QString errorMsg = "Failed to parse contact data from API response";
-        qWarning() << errorMsg;
-        emit errorOccurred(errorMsg);
+        // Queued, as receivers may open a dialog while the parser is mid-chunk
+        onContact = [this](const Contact &contact) {
+            qCDebug(lcNetwork) << "Successfully fetched contact:" << contact.fullName();
+            QMetaObject::invokeMethod(this, [this, contact]() { emit contactFetched(contact); },
+                                      Qt::QueuedConnection);
+        };
     }
+    m_parsers[reply] = std::make_unique<ContactStreamParser>(std::move(onContact));
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { onReplyReadyRead(reply); });
 }
 
-Contact NetworkManager::parseJsonResponse(const QByteArray &data)
+void NetworkManager::onReplyReadyRead(QNetworkReply *reply)
 {
-    Contact contact;
-    
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull() || !doc.isObject()) {
-        qWarning() << "Invalid JSON response";
-        return contact;
+    auto it = m_parsers.find(reply);
+    if (it == m_parsers.end()) return;
+
+    const int before = m_batch.contacts.size();
+    // Error pages are not parsed; finished() reports them
+    if (reply->error() == QNetworkReply::NoError) {
+        it->second->feed(reply->readAll());
+    } else {
+        reply->readAll();
     }
 
-    QJsonObject root = doc.object();
-    
-    // Check if results array exists
-    if (!root.contains("results") || !root["results"].isArray()) {
-        qWarning() << "No results array in response";
-        return contact;
+    if (reply->property("operation").toInt() == FetchContactBatchOp
+        && m_batch.contacts.size() != before) {
+        emit batchProgress(m_batch.contacts.size(), m_batch.requested);
     }
+}
 
-    QJsonArray results = root["results"].toArray();
-    if (results.isEmpty()) {
-        qWarning() << "Empty results array";
-        return contact;
+void NetworkManager::issueBatchRequests()
+{
+    // After a failure only the requests already sent are waited for
+    while (m_batch.error.isEmpty() && m_batch.unrequested > 0
+           && m_batch.inFlight < MaxConcurrentRequests) {
+        const int results = qMin(m_batch.unrequested, MaxResultsPerRequest);
+        m_batch.unrequested -= results;
+        ++m_batch.inFlight;
+        sendRequest(FetchContactBatchOp, results);
     }
+}
+
+void NetworkManager::onReplyFinished(QNetworkReply *reply)
+{
+    const int operation = reply->property("operation").toInt();
+    const qint64 startedNs = reply->property("startedNs").toLongLong();
+    reply->deleteLater();
 
-    // Get first result
-    QJsonObject user = results[0].toObject();
+    // Whatever arrived after the last readyRead()
+    onReplyReadyRead(reply);
+    auto it = m_parsers.find(reply);
+    std::unique_ptr<ContactStreamParser> parser = std::move(it->second);
+    m_parsers.erase(it);
 
-    // Extract name
-    if (user.contains("name") && user["name"].isObject()) {
-        QJsonObject name = user["name"].toObject();
-        contact.firstName = name["first"].toString();
-        contact.lastName = name["last"].toString();
-    }
+    if (operation == FetchContactBatchOp) {
+        onBatchReply(reply, *parser);
+    } else {
+        LatencyHistogram &latency = m_metrics.histogram(operation);
+        QString errorMsg;
+        if (reply->error() != QNetworkReply::NoError) {
+            errorMsg = "Network error: " + reply->errorString();
+        } else if (!parser->finish() || parser->contactCount() == 0) {
+            errorMsg = "Failed to parse contact data from API response";
+        }
+        latency.record(m_clock.nsecsElapsed() - startedNs, !errorMsg.isEmpty());
 
-    // Extract email
-    if (user.contains("email")) {
-        contact.email = user["email"].toString();
+        // A contact already handed over stands, even if the rest of the
+        // response was lost
+        if (!errorMsg.isEmpty() && parser->contactCount() == 0) {
+            qCWarning(lcNetwork) << errorMsg << parser->errorString();
+            emit errorOccurred(errorMsg);
+        }
     }
 
-    // Extract phone
-    if (user.contains("phone")) {
-        contact.phone = user["phone"].toString();
+    if (--m_activeRequests == 0) {
+        emit fetchFinished();
     }
+}
 
-    // Extract location
-    if (user.contains("location") && user["location"].isObject()) {
-        QJsonObject location = user["location"].toObject();
-        
-        if (location.contains("city")) {
-            contact.city = location["city"].toString();
+void NetworkManager::onBatchReply(QNetworkReply *reply, ContactStreamParser &parser)
+{
+    LatencyHistogram &latency = m_metrics.histogram(FetchContactBatchOp);
+    const qint64 startedNs = reply->property("startedNs").toLongLong();
+    --m_batch.inFlight;
+
+    // Contacts streamed before a failure are kept
+    bool failed = true;
+    if (reply->error() != QNetworkReply::NoError) {
+        if (m_batch.error.isEmpty()) {
+            m_batch.error = "Network error: " + reply->errorString();
         }
-        
-        if (location.contains("country")) {
-            contact.country = location["country"].toString();
+    } else if (!parser.finish() || parser.contactCount() == 0) {
+        if (m_batch.error.isEmpty()) {
+            m_batch.error = "Failed to parse contact data from API response";
         }
+        qCWarning(lcNetwork) << parser.errorString();
+    } else {
+        failed = false;
     }
+    latency.record(m_clock.nsecsElapsed() - startedNs, failed);
+
+    issueBatchRequests();
+    if (m_batch.inFlight > 0) return;
+
+    // Last reply of the batch
+    Batch batch = std::move(m_batch);
+    m_batch = Batch();
+    qCInfo(lcNetwork) << "Batch fetched" << batch.contacts.size() << "of" << batch.requested << "contacts";
 
-    return contact;
+    if (!batch.contacts.isEmpty()) {
+        emit contactsFetched(batch.contacts);
+    }
+    if (!batch.error.isEmpty()) {
+        qCWarning(lcNetwork) << batch.error;
+        emit errorOccurred(batch.error);
+    }
 }
@@ -2,30 +2,77 @@
 #define NETWORKMANAGER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QUrl>
+#include <QVector>
+#include <memory>
+#include <unordered_map>
 #include "contact.h"
+#include "contactstreamparser.h"
+#include "operationmetrics.h"
 
 /**
  * @brief Manages network operations for fetching contact data
  * 
  * This class demonstrates Qt's network capabilities by fetching
- * random user data from the RandomUser.me API
+ * random user data from the RandomUser.me API, or from any server that
+ * answers the same query at baseUrl().
+ *
+ * Batches are split into requests of at most MaxResultsPerRequest
+ * contacts, of which MaxConcurrentRequests run at a time. The access
+ * manager keeps the connections alive between requests (and multiplexes
+ * over one connection where the server speaks HTTP/2), so a large batch
+ * costs a handful of handshakes. Results are collected and delivered in
+ * a single contactsFetched() for one bulk insert.
+ *
+ * Responses are parsed as they download (see ContactStreamParser), so a
+ * contact is available as soon as its part of the body has arrived and
+ * no response is ever held in full.
  */
 class NetworkManager : public QObject
 {
     Q_OBJECT
 
 public:
+    // Requests with a latency histogram in metrics(), measured from
+    // sending the request to having parsed the reply
+    enum Operation {
+        FetchRandomContactOp,
+        FetchContactBatchOp,   // one request of a batch
+        OperationCount
+    };
+
+    static constexpr int MaxResultsPerRequest = 500;
+    // Matches the access manager's per-host connection limit for HTTP/1.1
+    static constexpr int MaxConcurrentRequests = 6;
+
     explicit NetworkManager(QObject *parent = nullptr);
     ~NetworkManager();
 
+    // CONTACTMANAGER_API_URL, or RandomUser.me when unset
+    static QUrl defaultBaseUrl();
+    void setBaseUrl(const QUrl &url) { m_baseUrl = url; }
+    QUrl baseUrl() const { return m_baseUrl; }
+
     // Fetch random contact from API
     void fetchRandomContact();
-    bool isBusy() const { return m_busy; }
+    // Fetch count random contacts; ignored while another batch runs
+    void fetchRandomContacts(int count);
+    bool isBusy() const { return m_activeRequests > 0; }
+    bool isBatchRunning() const { return m_batch.requested > 0; }
+
+    // Latency, count and error count per request type; an error is a
+    // network failure or an unusable response
+    const OperationMetrics &metrics() const { return m_metrics; }
+    void resetMetrics() { m_metrics.reset(); }
 
 signals:
     void contactFetched(const Contact &contact);
+    // Everything a batch fetched, also after a failure part way through
+    void contactsFetched(const QVector<Contact> &contacts);
+    void batchProgress(int fetched, int requested);
     void fetchStarted();
     void fetchFinished();
     void errorOccurred(const QString &error);
@@ -34,10 +81,27 @@ private slots:
     void onReplyFinished(QNetworkReply *reply);
 
 private:
+    struct Batch {
+        int requested = 0;     // 0 when no batch runs
+        int unrequested = 0;   // contacts not yet asked for
+        int inFlight = 0;
+        QVector<Contact> contacts;
+        QString error;
+    };
+
     QNetworkAccessManager *m_networkManager;
-    bool m_busy;
+    QUrl m_baseUrl;
+    int m_activeRequests;
+    Batch m_batch;
+    QElapsedTimer m_clock;
+    OperationMetrics m_metrics;
+    // One per reply in flight
+    std::unordered_map<QNetworkReply *, std::unique_ptr<ContactStreamParser>> m_parsers;
     
-    Contact parseJsonResponse(const QByteArray &data);
+    void sendRequest(Operation operation, int results);
+    void issueBatchRequests();
+    void onReplyReadyRead(QNetworkReply *reply);
+    void onBatchReply(QNetworkReply *reply, ContactStreamParser &parser);
 };
 
 #endif // NETWORKMANAGER_H
@@ -0,0 +1,161 @@
+#include "operationmetrics.h"
+#include <QJsonObject>
+#include <QtAlgorithms>
+#include <cmath>
+
+// ============= LatencyHistogram =============
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(qint64 nanoseconds, bool failed)
+{
+    const quint64 value = qMin(quint64(qMax<qint64>(0, nanoseconds)), MaxValueNs);
+
+    m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(value, std::memory_order_relaxed);
+    if (failed) {
+        m_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    quint64 max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<quint64> &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_errors.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::meanNs() const
+{
+    const quint64 n = count();
+    return n ? double(m_total.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+qint64 LatencyHistogram::percentileNs(double q) const
+{
+    // Sum the buckets rather than trusting m_count, which a concurrent
+    // record() may have bumped before its bucket
+    quint64 counts[BucketCount];
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0;
+
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, q, 1.0) * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return qMin(qint64(bucketMidpoint(i)), maxNs());
+        }
+    }
+    return maxNs();
+}
+
+int LatencyHistogram::bucketOf(quint64 value)
+{
+    if (value < quint64(SubBucketCount)) return int(value);
+
+    const int msb = 63 - qCountLeadingZeroBits(value);
+    const int shift = msb - SubBucketBits;
+    const int sub = int((value >> shift) & (SubBucketCount - 1));
+    return (shift + 1) * SubBucketCount + sub;
+}
+
+quint64 LatencyHistogram::bucketMidpoint(int bucket)
+{
+    if (bucket < SubBucketCount) return quint64(bucket);
+
+    const int shift = bucket / SubBucketCount - 1;
+    const quint64 sub = quint64(bucket % SubBucketCount);
+    const quint64 lower = (quint64(SubBucketCount) + sub) << shift;
+    return lower + ((quint64(1) << shift) >> 1);
+}
+
+// ============= OperationMetrics =============
+
+OperationMetrics::OperationMetrics(const QStringList &operations)
+    : m_operations(operations)
+{
+    m_histograms.reserve(size_t(operations.size()));
+    for (int i = 0; i < operations.size(); ++i) {
+        m_histograms.push_back(std::make_unique<LatencyHistogram>());
+    }
+}
+
+QVector<LatencySummary> OperationMetrics::summaries() const
+{
+    QVector<LatencySummary> result;
+    for (int i = 0; i < m_operations.size(); ++i) {
+        const LatencyHistogram &histogram = *m_histograms[size_t(i)];
+        if (histogram.count() == 0) continue;
+
+        LatencySummary summary;
+        summary.operation = m_operations.at(i);
+        summary.count = histogram.count();
+        summary.errors = histogram.errors();
+        summary.p50Ns = histogram.percentileNs(0.50);
+        summary.p99Ns = histogram.percentileNs(0.99);
+        summary.maxNs = histogram.maxNs();
+        summary.meanNs = histogram.meanNs();
+        result.append(summary);
+    }
+    return result;
+}
+
+QJsonArray OperationMetrics::toJson() const
+{
+    QJsonArray array;
+    for (const LatencySummary &summary : summaries()) {
+        QJsonObject object;
+        object["operation"] = summary.operation;
+        object["count"] = qint64(summary.count);
+        object["errors"] = qint64(summary.errors);
+        object["error_rate"] = summary.errorRate();
+        object["p50_us"] = summary.p50Ns / 1e3;
+        object["p99_us"] = summary.p99Ns / 1e3;
+        object["max_us"] = summary.maxNs / 1e3;
+        object["mean_us"] = summary.meanNs / 1e3;
+        array.append(object);
+    }
+    return array;
+}
+
+void OperationMetrics::reset()
+{
+    for (const std::unique_ptr<LatencyHistogram> &histogram : m_histograms) {
+        histogram->reset();
+    }
+}
+
+// ============= ScopedLatency =============
+
+ScopedLatency::ScopedLatency(LatencyHistogram &histogram, const std::atomic<quint64> *errorCounter)
+    : m_histogram(histogram)
+    , m_errorCounter(errorCounter)
+    , m_errorsBefore(errorCounter ? errorCounter->load(std::memory_order_relaxed) : 0)
+    , m_failed(false)
+{
+    m_timer.start();
+}
+
+ScopedLatency::~ScopedLatency()
+{
+    const bool failed = m_failed
+        || (m_errorCounter && m_errorCounter->load(std::memory_order_relaxed) != m_errorsBefore);
+    m_histogram.record(m_timer.nsecsElapsed(), failed);
+}
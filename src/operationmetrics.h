@@ -0,0 +1,118 @@
+#ifndef OPERATIONMETRICS_H
+#define OPERATIONMETRICS_H
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Lock-free latency histogram with log-linear buckets
+ *
+ * Each power of two is split into SubBucketCount buckets, so a reported
+ * percentile is within about 6% of the true value from nanoseconds up
+ * to MaxValueNs. record() is a handful of relaxed atomic increments and
+ * may be called from any thread; readers see a slightly stale but
+ * consistent-enough view without stopping writers.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int ValueBits = 40;   // about 18 minutes in ns
+    static constexpr quint64 MaxValueNs = (quint64(1) << ValueBits) - 1;
+    static constexpr int BucketCount = (ValueBits - SubBucketBits + 1) * SubBucketCount;
+
+    LatencyHistogram();
+
+    void record(qint64 nanoseconds, bool failed = false);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    quint64 errors() const { return m_errors.load(std::memory_order_relaxed); }
+    qint64 maxNs() const { return qint64(m_max.load(std::memory_order_relaxed)); }
+    double meanNs() const;
+    // Value at quantile q in [0, 1]; 0 when nothing was recorded
+    qint64 percentileNs(double q) const;
+
+private:
+    std::atomic<quint64> m_buckets[BucketCount];
+    std::atomic<quint64> m_count;
+    std::atomic<quint64> m_errors;
+    std::atomic<quint64> m_total;
+    std::atomic<quint64> m_max;
+
+    static int bucketOf(quint64 value);
+    static quint64 bucketMidpoint(int bucket);
+};
+
+struct LatencySummary {
+    QString operation;
+    quint64 count = 0;
+    quint64 errors = 0;
+    qint64 p50Ns = 0;
+    qint64 p99Ns = 0;
+    qint64 maxNs = 0;
+    double meanNs = 0;
+
+    double errorRate() const { return count ? double(errors) / count : 0.0; }
+};
+
+/**
+ * @brief A fixed set of named latency histograms
+ *
+ * Operations are identified by index (an owner's enum) so recording
+ * never looks anything up; the names are only used for reporting.
+ */
+class OperationMetrics
+{
+public:
+    explicit OperationMetrics(const QStringList &operations);
+
+    LatencyHistogram &histogram(int operation) { return *m_histograms[size_t(operation)]; }
+    const QStringList &operations() const { return m_operations; }
+
+    // Operations that have been called at least once
+    QVector<LatencySummary> summaries() const;
+    // One object per called operation: count, errors, error_rate, p50_us,
+    // p99_us, max_us, mean_us
+    QJsonArray toJson() const;
+    void reset();
+
+private:
+    QStringList m_operations;
+    std::vector<std::unique_ptr<LatencyHistogram>> m_histograms;
+};
+
+/**
+ * @brief Records the time until it goes out of scope
+ *
+ * With an error counter the operation counts as failed when the counter
+ * moved while in scope, which covers every early error return of a
+ * method that reports errors through one setter.
+ */
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram &histogram,
+                           const std::atomic<quint64> *errorCounter = nullptr);
+    ~ScopedLatency();
+
+    void setFailed(bool failed = true) { m_failed = failed; }
+
+private:
+    Q_DISABLE_COPY(ScopedLatency)
+
+    LatencyHistogram &m_histogram;
+    const std::atomic<quint64> *m_errorCounter;
+    quint64 m_errorsBefore;
+    bool m_failed;
+    QElapsedTimer m_timer;
+};
+
+#endif // OPERATIONMETRICS_H
@@ -0,0 +1,113 @@
+#include "schemamigrator.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+} // namespace
+
+void SchemaMigrator::addMigration(int version, const QString &description,
+                                  const QStringList &statements)
+{
+    m_migrations.append({version, description, statements, Step()});
+}
+
+void SchemaMigrator::addMigration(int version, const QString &description, const Step &step)
+{
+    m_migrations.append({version, description, QStringList(), step});
+}
+
+int SchemaMigrator::latestVersion() const
+{
+    int latest = 0;
+    for (const Migration &migration : m_migrations) {
+        latest = qMax(latest, migration.version);
+    }
+    return latest;
+}
+
+int SchemaMigrator::currentVersion(const QSqlDatabase &database, QString *error)
+{
+    QSqlQuery query(database);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        setError(error, "Failed to read schema version: " + query.lastError().text());
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool SchemaMigrator::migrate(QSqlDatabase &database, QString *error) const
+{
+    int current = currentVersion(database, error);
+    if (current < 0) return false;
+
+    const int latest = latestVersion();
+    if (current > latest) {
+        setError(error, QString("Database schema version %1 is newer than this build supports (%2)")
+                            .arg(current).arg(latest));
+        return false;
+    }
+
+    QVector<Migration> pending;
+    for (const Migration &migration : m_migrations) {
+        if (migration.version > current) pending.append(migration);
+    }
+    std::sort(pending.begin(), pending.end(), [](const Migration &a, const Migration &b) {
+        return a.version < b.version;
+    });
+
+    for (const Migration &migration : pending) {
+        if (!apply(database, migration, error)) {
+            return false;
+        }
+        qDebug() << "Schema migrated to version" << migration.version << "-" << migration.description;
+    }
+    return true;
+}
+
+bool SchemaMigrator::apply(QSqlDatabase &database, const Migration &migration, QString *error) const
+{
+    if (!database.transaction()) {
+        setError(error, "Failed to begin migration: " + database.lastError().text());
+        return false;
+    }
+
+    auto fail = [&](const QString &message) {
+        setError(error, QString("Migration %1 (%2) failed: %3")
+                            .arg(migration.version).arg(migration.description, message));
+        database.rollback();
+        return false;
+    };
+
+    QSqlQuery query(database);
+    for (const QString &statement : migration.statements) {
+        if (!query.exec(statement)) {
+            return fail(query.lastError().text());
+        }
+    }
+
+    if (migration.step) {
+        QString stepError;
+        if (!migration.step(database, &stepError)) {
+            return fail(stepError);
+        }
+    }
+
+    // user_version lives in the database header and commits with the rest
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+        return fail(query.lastError().text());
+    }
+
+    if (!database.commit()) {
+        return fail(database.lastError().text());
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief Upgrades an SQLite database in place, keyed on PRAGMA user_version
+ *
+ * Each migration moves the schema from version N-1 to N, either with a
+ * list of SQL statements or with a C++ step for changes SQL alone cannot
+ * express (backfills, conditional DDL). migrate() applies every pending
+ * migration in version order, each in its own transaction together with
+ * the user_version bump, so an interrupted upgrade resumes where it
+ * stopped. Databases newer than the latest known version are refused.
+ */
+class SchemaMigrator
+{
+public:
+    using Step = std::function<bool(QSqlDatabase &database, QString *error)>;
+
+    struct Migration {
+        int version;
+        QString description;
+        QStringList statements;
+        Step step;
+    };
+
+    void addMigration(int version, const QString &description, const QStringList &statements);
+    void addMigration(int version, const QString &description, const Step &step);
+
+    int latestVersion() const;
+    static int currentVersion(const QSqlDatabase &database, QString *error = nullptr);
+
+    bool migrate(QSqlDatabase &database, QString *error = nullptr) const;
+
+private:
+    QVector<Migration> m_migrations;
+
+    bool apply(QSqlDatabase &database, const Migration &migration, QString *error) const;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,1268 @@
+#include "sqlitestorageengine.h"
+#include "connectionpool.h"
+#include "contactnormalizer.h"
+#include "nativecontactreader.h"
+#include "schemamigrator.h"
+#include <QMap>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QThread>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+
+// Column list shared by every contact SELECT, read back by position
+const QString ContactColumns = QStringLiteral("id, first_name, last_name, email, phone, city, country");
+
+void hydrateContact(const QSqlQuery &query, Contact *contact)
+{
+    contact->id = query.value(0).toInt();
+    contact->firstName = query.value(1).toString();
+    contact->lastName = query.value(2).toString();
+    contact->email = query.value(3).toString();
+    contact->phone = query.value(4).toString();
+    contact->city = query.value(5).toString();
+    contact->country = query.value(6).toString();
+}
+
+void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+// Empty normalized values are stored as NULL and stay out of the indexes
+QVariant normalizedValue(const QString &value)
+{
+    return value.isEmpty() ? QVariant() : QVariant(value);
+}
+
+bool backfillNormalizedColumns(QSqlDatabase &database, QString *error)
+{
+    QSqlQuery query(database);
+    const char *const statements[] = {
+        "ALTER TABLE contacts ADD COLUMN email_norm TEXT",
+        "ALTER TABLE contacts ADD COLUMN phone_norm TEXT",
+        // Recreated by createSearchIndex() to fire only when indexed text
+        // changes, so the backfill below leaves the FTS index alone
+        "DROP TRIGGER IF EXISTS contacts_fts_au"
+    };
+    for (const char *statement : statements) {
+        if (!query.exec(statement)) {
+            setError(error, query.lastError().text());
+            return false;
+        }
+    }
+
+    // Phone normalization has no SQL equivalent, so existing rows go through C++
+    QSqlQuery select(database);
+    select.setForwardOnly(true);
+    if (!select.exec("SELECT id, email, phone FROM contacts")) {
+        setError(error, select.lastError().text());
+        return false;
+    }
+
+    QSqlQuery update(database);
+    update.prepare("UPDATE contacts SET email_norm=:emailNorm, phone_norm=:phoneNorm WHERE id=:id");
+    while (select.next()) {
+        update.bindValue(":id", select.value(0));
+        update.bindValue(":emailNorm", normalizedValue(ContactNormalizer::email(select.value(1).toString())));
+        update.bindValue(":phoneNorm", normalizedValue(ContactNormalizer::phone(select.value(2).toString())));
+        if (!update.exec()) {
+            setError(error, update.lastError().text());
+            return false;
+        }
+    }
+
+    const char *const indexes[] = {
+        "CREATE INDEX IF NOT EXISTS idx_contacts_email_norm "
+        "ON contacts(email_norm) WHERE email_norm IS NOT NULL",
+        "CREATE INDEX IF NOT EXISTS idx_contacts_phone_norm "
+        "ON contacts(phone_norm) WHERE phone_norm IS NOT NULL"
+    };
+    for (const char *statement : indexes) {
+        if (!query.exec(statement)) {
+            setError(error, query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SqliteStorageEngine::SqliteStorageEngine(const QString &databasePath)
+    : m_path(databasePath)
+    , m_connectionName(QString("contacts-main-%1").arg(quintptr(this)))
+    , m_ownerThread(nullptr)
+    , m_open(false)
+    , m_ftsAvailable(false)
+    , m_nativeReader(new NativeContactReader)
+    , m_nativeReadsEnabled(NativeContactReader::isAvailable())
+    , m_readPool(new ConnectionPool(ConnectionPool::ReadOnly))
+    , m_writePool(new ConnectionPool(ConnectionPool::ReadWrite))
+{
+}
+
+SqliteStorageEngine::~SqliteStorageEngine()
+{
+    close();
+}
+
+// ============= Connections =============
+
+bool SqliteStorageEngine::prepare(QString *error)
+{
+    if (m_open) return true;
+
+    const QString name = QString("contacts-prepare-%1").arg(quintptr(QThread::currentThread()));
+    bool ok = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(m_path);
+        database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+        if (!database.open()) {
+            setError(error, "Failed to connect: " + database.lastError().text());
+        } else {
+            configureConnection(database);
+            ok = migrations().migrate(database, error);
+            // Builds the FTS index here if missing; createSchema() then finds it
+            if (ok && !createSearchIndex(database)) {
+                qWarning() << "FTS5 unavailable, falling back to LIKE search";
+            }
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return ok;
+}
+
+bool SqliteStorageEngine::open(QString *error)
+{
+    if (m_open) return true;
+
+    {
+        QSqlDatabase database = QSqlDatabase::contains(m_connectionName)
+            ? QSqlDatabase::database(m_connectionName, false)
+            : QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        database.setDatabaseName(m_path);
+        database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+        if (!database.open()) {
+            setError(error, "Failed to connect: " + database.lastError().text());
+            return false;
+        }
+
+        configureConnection(database);
+    }
+
+    qDebug() << "Successfully connected to SQLite database:" << m_path;
+
+    m_ownerThread = QThread::currentThread();
+    m_readPool->setDatabasePath(m_path);
+    m_writePool->setDatabasePath(m_path);
+    m_open = true;
+
+    if (m_nativeReadsEnabled) {
+        openNativeReader();
+    }
+    return true;
+}
+
+void SqliteStorageEngine::close()
+{
+    if (!m_open) return;
+
+    m_open = false;
+    m_readPool->invalidate();
+    m_writePool->invalidate();
+    m_nativeReader->close();
+
+    {
+        QSqlDatabase database = QSqlDatabase::database(m_connectionName, false);
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+    m_ownerThread = nullptr;
+}
+
+bool SqliteStorageEngine::onOwnerThread() const
+{
+    return QThread::currentThread() == m_ownerThread;
+}
+
+QSqlDatabase SqliteStorageEngine::connection(QString *error)
+{
+    if (onOwnerThread()) {
+        return QSqlDatabase::database(m_connectionName, false);
+    }
+    return m_writePool->connection(error);
+}
+
+QSqlDatabase SqliteStorageEngine::readConnection(QString *error)
+{
+    if (onOwnerThread()) {
+        return QSqlDatabase::database(m_connectionName, false);
+    }
+    return m_readPool->connection(error);
+}
+
+void SqliteStorageEngine::configureConnection(QSqlDatabase &database)
+{
+    // WAL lets the pooled connections work alongside this one;
+    // with WAL, synchronous=NORMAL only syncs at checkpoints
+    const char *const pragmas[] = {
+        "PRAGMA journal_mode = WAL",
+        "PRAGMA synchronous = NORMAL",
+        "PRAGMA cache_size = -32000",        // 32 MiB page cache
+        "PRAGMA mmap_size = 268435456",      // map up to 256 MiB of the file
+        "PRAGMA temp_store = MEMORY"
+    };
+
+    QSqlQuery query(database);
+    for (const char *pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "Failed to apply" << pragma << ":" << query.lastError().text();
+        }
+    }
+}
+
+void SqliteStorageEngine::setNativeReadsEnabled(bool enabled)
+{
+    m_nativeReadsEnabled = enabled && NativeContactReader::isAvailable();
+
+    if (!m_nativeReadsEnabled) {
+        m_nativeReader->close();
+    } else if (m_open && !m_nativeReader->isOpen()) {
+        openNativeReader();
+    }
+}
+
+bool SqliteStorageEngine::nativeReadsActive() const
+{
+    return m_nativeReadsEnabled && m_nativeReader->isOpen();
+}
+
+void SqliteStorageEngine::openNativeReader()
+{
+    if (!m_nativeReader->open(QSqlDatabase::database(m_connectionName, false))) {
+        qWarning() << "Native reads unavailable, using QtSql:" << m_nativeReader->lastError();
+    }
+}
+
+// ============= Schema =============
+
+SchemaMigrator SqliteStorageEngine::migrations()
+{
+    SchemaMigrator migrator;
+
+    // Databases from before versioning already have this table at version 0
+    migrator.addMigration(1, "contacts table", QStringList{R"(
+        CREATE TABLE IF NOT EXISTS contacts (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            first_name TEXT NOT NULL,
+            last_name TEXT NOT NULL,
+            email TEXT,
+            phone TEXT,
+            city TEXT,
+            country TEXT,
+            created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+        )
+    )"});
+
+    // The name index carries every selected column, so ordered reads and
+    // keyset pages walk it without touching the table or sorting. The
+    // rowid is implicit in the email and phone indexes, which makes them
+    // covering for id lookups.
+    migrator.addMigration(2, "covering indexes for the default sort, email and phone", QStringList{
+        "CREATE INDEX IF NOT EXISTS idx_contacts_name "
+        "ON contacts(first_name, last_name, id, email, phone, city, country)",
+        "CREATE INDEX IF NOT EXISTS idx_contacts_email ON contacts(email)",
+        "CREATE INDEX IF NOT EXISTS idx_contacts_phone ON contacts(phone)",
+        "ANALYZE"
+    });
+
+    migrator.addMigration(3, "normalized email and phone lookup columns", &backfillNormalizedColumns);
+
+    // AUTOINCREMENT keeps sequence numbers from being reused after
+    // compaction. Only updates that change a visible column are logged;
+    // the existing rows are recorded as inserts so a consumer starting
+    // from 0 sees the whole book.
+    migrator.addMigration(4, "contact change log", QStringList{
+        R"(CREATE TABLE contact_changes (
+            seq INTEGER PRIMARY KEY AUTOINCREMENT,
+            contact_id INTEGER NOT NULL,
+            op INTEGER NOT NULL
+        ))",
+        "CREATE INDEX idx_contact_changes_contact ON contact_changes(contact_id, seq)",
+        R"(CREATE TRIGGER contacts_changes_ai AFTER INSERT ON contacts BEGIN
+            INSERT INTO contact_changes(contact_id, op) VALUES (new.id, 1);
+        END)",
+        R"(CREATE TRIGGER contacts_changes_au AFTER UPDATE ON contacts
+        WHEN old.first_name IS NOT new.first_name OR old.last_name IS NOT new.last_name
+          OR old.email IS NOT new.email OR old.phone IS NOT new.phone
+          OR old.city IS NOT new.city OR old.country IS NOT new.country BEGIN
+            INSERT INTO contact_changes(contact_id, op) VALUES (new.id, 2);
+        END)",
+        R"(CREATE TRIGGER contacts_changes_ad AFTER DELETE ON contacts BEGIN
+            INSERT INTO contact_changes(contact_id, op) VALUES (old.id, 3);
+        END)",
+        "INSERT INTO contact_changes(contact_id, op) SELECT id, 1 FROM contacts ORDER BY id"
+    });
+
+    // contact_facets holds one row per (facet, value) with its contact
+    // count, kept exact by triggers: each write touches at most four
+    // counter rows by primary key, whatever the size of the table. Facet
+    // 0 is country and 1 is city (ContactFacet); NULL counts as ''.
+    migrator.addMigration(5, "facet counts by country and city", QStringList{
+        R"(CREATE TABLE contact_facets (
+            facet INTEGER NOT NULL,
+            value TEXT NOT NULL,
+            count INTEGER NOT NULL,
+            PRIMARY KEY (facet, value)
+        ) WITHOUT ROWID)",
+        "INSERT INTO contact_facets (facet, value, count) "
+        "SELECT 0, COALESCE(country, ''), COUNT(*) FROM contacts GROUP BY 2",
+        "INSERT INTO contact_facets (facet, value, count) "
+        "SELECT 1, COALESCE(city, ''), COUNT(*) FROM contacts GROUP BY 2",
+        R"(CREATE TRIGGER contacts_facets_ai AFTER INSERT ON contacts BEGIN
+            INSERT INTO contact_facets VALUES (0, COALESCE(new.country, ''), 1)
+                ON CONFLICT (facet, value) DO UPDATE SET count = count + 1;
+            INSERT INTO contact_facets VALUES (1, COALESCE(new.city, ''), 1)
+                ON CONFLICT (facet, value) DO UPDATE SET count = count + 1;
+        END)",
+        R"(CREATE TRIGGER contacts_facets_ad AFTER DELETE ON contacts BEGIN
+            UPDATE contact_facets SET count = count - 1
+                WHERE facet = 0 AND value = COALESCE(old.country, '');
+            UPDATE contact_facets SET count = count - 1
+                WHERE facet = 1 AND value = COALESCE(old.city, '');
+            DELETE FROM contact_facets
+                WHERE facet = 0 AND value = COALESCE(old.country, '') AND count <= 0;
+            DELETE FROM contact_facets
+                WHERE facet = 1 AND value = COALESCE(old.city, '') AND count <= 0;
+        END)",
+        R"(CREATE TRIGGER contacts_facets_au AFTER UPDATE OF city, country ON contacts
+        WHEN old.city IS NOT new.city OR old.country IS NOT new.country BEGIN
+            INSERT INTO contact_facets VALUES (0, COALESCE(new.country, ''), 1)
+                ON CONFLICT (facet, value) DO UPDATE SET count = count + 1;
+            INSERT INTO contact_facets VALUES (1, COALESCE(new.city, ''), 1)
+                ON CONFLICT (facet, value) DO UPDATE SET count = count + 1;
+            UPDATE contact_facets SET count = count - 1
+                WHERE facet = 0 AND value = COALESCE(old.country, '');
+            UPDATE contact_facets SET count = count - 1
+                WHERE facet = 1 AND value = COALESCE(old.city, '');
+            DELETE FROM contact_facets
+                WHERE facet = 0 AND value = COALESCE(old.country, '') AND count <= 0;
+            DELETE FROM contact_facets
+                WHERE facet = 1 AND value = COALESCE(old.city, '') AND count <= 0;
+        END)",
+        // Filtering on a facet walks these in sort order, no sorting needed
+        "CREATE INDEX idx_contacts_country ON contacts(country, first_name, last_name, id)",
+        "CREATE INDEX idx_contacts_city ON contacts(city, first_name, last_name, id)"
+    });
+
+    return migrator;
+}
+
+bool SqliteStorageEngine::createSchema(QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    if (!migrations().migrate(database, error)) {
+        return false;
+    }
+
+    qDebug() << "Schema at version" << SchemaMigrator::currentVersion(database);
+
+    m_ftsAvailable = createSearchIndex(database);
+    if (!m_ftsAvailable) {
+        qWarning() << "FTS5 unavailable, falling back to LIKE search";
+    }
+    return true;
+}
+
+QStringList SqliteStorageEngine::verifyQueryPlans()
+{
+    struct Expectation {
+        QString sql;
+        QString index;
+    };
+    const Expectation expectations[] = {
+        {"SELECT " + ContactColumns + " FROM contacts ORDER BY first_name, last_name, id",
+         "idx_contacts_name"},
+        {"SELECT " + ContactColumns + " FROM contacts ORDER BY first_name, last_name, id LIMIT 256",
+         "idx_contacts_name"},
+        {"SELECT " + ContactColumns + " FROM contacts "
+         "WHERE (first_name, last_name, id) > ('a', 'b', 1) "
+         "ORDER BY first_name, last_name, id LIMIT 256",
+         "idx_contacts_name"},
+        {"SELECT id FROM contacts WHERE email = 'a@example.com'", "idx_contacts_email"},
+        {"SELECT id FROM contacts WHERE phone = '+15550100'", "idx_contacts_phone"},
+        {"SELECT id FROM contacts WHERE email_norm = 'a@example.com'", "idx_contacts_email_norm"},
+        {"SELECT id FROM contacts WHERE phone_norm = '+15550100'", "idx_contacts_phone_norm"}
+    };
+
+    QStringList problems;
+    QSqlDatabase database = readConnection();
+    if (!database.isOpen()) {
+        problems.append("no connection");
+        return problems;
+    }
+
+    QSqlQuery query(database);
+    for (const Expectation &expectation : expectations) {
+        if (!query.exec("EXPLAIN QUERY PLAN " + expectation.sql)) {
+            problems.append(expectation.sql + ": " + query.lastError().text());
+            continue;
+        }
+
+        // The plan detail is the last column of each row
+        QStringList plan;
+        while (query.next()) {
+            plan.append(query.value(3).toString());
+        }
+        const QString detail = plan.join("; ");
+
+        if (!detail.contains("COVERING INDEX " + expectation.index)
+            || detail.contains("TEMP B-TREE")) {
+            problems.append(expectation.sql + " -> " + detail);
+        }
+    }
+    return problems;
+}
+
+bool SqliteStorageEngine::createSearchIndex(QSqlDatabase &database)
+{
+    QSqlQuery query(database);
+
+    query.exec("SELECT 1 FROM sqlite_master WHERE type='table' AND name='contacts_fts'");
+    bool indexExisted = query.next();
+    query.finish();
+
+    // External-content FTS5 table: the text lives only in 'contacts',
+    // the index is kept in sync by the triggers below.
+    const QStringList statements = {
+        R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS contacts_fts USING fts5(
+            first_name, last_name, email, phone, city, country,
+            content='contacts', content_rowid='id',
+            tokenize='unicode61 remove_diacritics 2'
+        )
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS contacts_fts_ai AFTER INSERT ON contacts BEGIN
+            INSERT INTO contacts_fts(rowid, first_name, last_name, email, phone, city, country)
+            VALUES (new.id, new.first_name, new.last_name, new.email, new.phone, new.city, new.country);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS contacts_fts_ad AFTER DELETE ON contacts BEGIN
+            INSERT INTO contacts_fts(contacts_fts, rowid, first_name, last_name, email, phone, city, country)
+            VALUES ('delete', old.id, old.first_name, old.last_name, old.email, old.phone, old.city, old.country);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS contacts_fts_au
+        AFTER UPDATE OF first_name, last_name, email, phone, city, country ON contacts BEGIN
+            INSERT INTO contacts_fts(contacts_fts, rowid, first_name, last_name, email, phone, city, country)
+            VALUES ('delete', old.id, old.first_name, old.last_name, old.email, old.phone, old.city, old.country);
+            INSERT INTO contacts_fts(rowid, first_name, last_name, email, phone, city, country)
+            VALUES (new.id, new.first_name, new.last_name, new.email, new.phone, new.city, new.country);
+        END
+        )"
+    };
+
+    database.transaction();
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            qWarning() << "Failed to create search index:" << query.lastError().text();
+            database.rollback();
+            return false;
+        }
+    }
+
+    // Databases created before the index existed need a one-off backfill
+    if (!indexExisted) {
+        if (!query.exec("INSERT INTO contacts_fts(contacts_fts) VALUES('rebuild')")) {
+            qWarning() << "Failed to backfill search index:" << query.lastError().text();
+            database.rollback();
+            return false;
+        }
+        qDebug() << "Search index built for existing contacts";
+    }
+
+    return database.commit();
+}
+
+// ============= Writes =============
+
+bool SqliteStorageEngine::prepareInsert(QSqlQuery &query)
+{
+    return query.prepare("INSERT INTO contacts (first_name, last_name, email, phone, city, country, "
+                        "email_norm, phone_norm) "
+                        "VALUES (:firstName, :lastName, :email, :phone, :city, :country, "
+                        ":emailNorm, :phoneNorm)");
+}
+
+void SqliteStorageEngine::bindInsert(QSqlQuery &query, const Contact &contact)
+{
+    query.bindValue(":firstName", contact.firstName);
+    query.bindValue(":lastName", contact.lastName);
+    query.bindValue(":email", contact.email);
+    query.bindValue(":phone", contact.phone);
+    query.bindValue(":city", contact.city);
+    query.bindValue(":country", contact.country);
+    query.bindValue(":emailNorm", normalizedValue(ContactNormalizer::email(contact.email)));
+    query.bindValue(":phoneNorm", normalizedValue(ContactNormalizer::phone(contact.phone)));
+}
+
+bool SqliteStorageEngine::insert(Contact *contact, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    prepareInsert(query);
+    bindInsert(query, *contact);
+
+    if (!query.exec()) {
+        setError(error, "Failed to add contact: " + query.lastError().text());
+        return false;
+    }
+
+    contact->id = query.lastInsertId().toInt();
+    return true;
+}
+
+int SqliteStorageEngine::insertBatch(const QVector<Contact> &contacts, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return -1;
+
+    QSqlQuery query(database);
+    if (!prepareInsert(query)) {
+        setError(error, "Failed to prepare insert: " + query.lastError().text());
+        return -1;
+    }
+
+    if (!database.transaction()) {
+        setError(error, "Failed to begin transaction: " + database.lastError().text());
+        return -1;
+    }
+
+    int inserted = 0;
+    for (const Contact &contact : contacts) {
+        if (!contact.isValid()) continue;
+
+        bindInsert(query, contact);
+        if (!query.exec()) {
+            setError(error, "Failed to add contact: " + query.lastError().text());
+            database.rollback();
+            return -1;
+        }
+        ++inserted;
+    }
+
+    if (!database.commit()) {
+        setError(error, "Failed to commit contacts: " + database.lastError().text());
+        database.rollback();
+        return -1;
+    }
+
+    return inserted;
+}
+
+bool SqliteStorageEngine::update(const Contact &contact, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.prepare("UPDATE contacts SET first_name=:firstName, last_name=:lastName, "
+                 "email=:email, phone=:phone, city=:city, country=:country, "
+                 "email_norm=:emailNorm, phone_norm=:phoneNorm "
+                 "WHERE id=:id");
+
+    query.bindValue(":id", contact.id);
+    bindInsert(query, contact);
+
+    if (!query.exec()) {
+        setError(error, "Failed to update contact: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::remove(int id, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.prepare("DELETE FROM contacts WHERE id=:id");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        setError(error, "Failed to delete contact: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::merge(const Contact &survivor, const QVector<int> &removedIds,
+                                QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    if (!database.transaction()) {
+        setError(error, "Failed to begin transaction: " + database.lastError().text());
+        return false;
+    }
+
+    QString stepError;
+    if (!update(survivor, &stepError)) {
+        setError(error, "Failed to merge contacts: " + stepError);
+        database.rollback();
+        return false;
+    }
+
+    QSqlQuery query(database);
+    query.prepare("DELETE FROM contacts WHERE id=:id");
+    for (int id : removedIds) {
+        query.bindValue(":id", id);
+        if (!query.exec()) {
+            setError(error, "Failed to merge contacts: " + query.lastError().text());
+            database.rollback();
+            return false;
+        }
+    }
+
+    if (!database.commit()) {
+        setError(error, "Failed to commit merge: " + database.lastError().text());
+        database.rollback();
+        return false;
+    }
+    return true;
+}
+
+// ============= Reads =============
+
+bool SqliteStorageEngine::stageIds(QSqlDatabase &database, const QVector<int> &ids,
+                                   QVector<Contact> *contacts, QString *error)
+{
+    QSqlQuery query(database);
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS bulk_ids (id INTEGER PRIMARY KEY)")
+        || !query.exec("DELETE FROM temp.bulk_ids")) {
+        setError(error, "Failed to stage ids: " + query.lastError().text());
+        return false;
+    }
+
+    if (!query.prepare("INSERT OR IGNORE INTO temp.bulk_ids (id) VALUES (:id)")) {
+        setError(error, "Failed to stage ids: " + query.lastError().text());
+        return false;
+    }
+    for (int id : ids) {
+        query.bindValue(":id", id);
+        if (!query.exec()) {
+            setError(error, "Failed to stage ids: " + query.lastError().text());
+            return false;
+        }
+    }
+
+    QSqlQuery select(database);
+    select.setForwardOnly(true);
+    if (!select.exec("SELECT " + ContactColumns + " FROM contacts "
+                     "WHERE id IN (SELECT id FROM temp.bulk_ids) "
+                     "ORDER BY first_name, last_name, id")) {
+        setError(error, "Failed to read contacts: " + select.lastError().text());
+        return false;
+    }
+    while (select.next()) {
+        contacts->append(Contact());
+        hydrateContact(select, &contacts->last());
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::removeMany(const QVector<int> &ids, QVector<Contact> *removed,
+                                     QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    if (!database.transaction()) {
+        setError(error, "Failed to begin transaction: " + database.lastError().text());
+        return false;
+    }
+
+    QVector<Contact> rows;
+    if (!stageIds(database, ids, &rows, error)) {
+        database.rollback();
+        return false;
+    }
+
+    QSqlQuery query(database);
+    if (!query.exec("DELETE FROM contacts WHERE id IN (SELECT id FROM temp.bulk_ids)")) {
+        setError(error, "Failed to delete contacts: " + query.lastError().text());
+        database.rollback();
+        return false;
+    }
+
+    if (!database.commit()) {
+        setError(error, "Failed to commit delete: " + database.lastError().text());
+        database.rollback();
+        return false;
+    }
+
+    *removed = rows;
+    return true;
+}
+
+bool SqliteStorageEngine::updateMany(const QVector<int> &ids, const ContactPatch &patch,
+                                     QVector<Contact> *previous, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    // Every row gets the same values, so the normalized columns are
+    // computed once here rather than per row
+    QStringList assignments;
+    QVariantMap values;
+    auto assign = [&](const char *column, const std::optional<QString> &value) {
+        if (!value) return;
+        const QString placeholder = QString(":") + column;
+        assignments.append(QString(column) + " = " + placeholder);
+        values.insert(placeholder, *value);
+    };
+    assign("first_name", patch.firstName);
+    assign("last_name", patch.lastName);
+    assign("email", patch.email);
+    assign("phone", patch.phone);
+    assign("city", patch.city);
+    assign("country", patch.country);
+    if (patch.email) {
+        assignments.append("email_norm = :email_norm");
+        values.insert(":email_norm", normalizedValue(ContactNormalizer::email(*patch.email)));
+    }
+    if (patch.phone) {
+        assignments.append("phone_norm = :phone_norm");
+        values.insert(":phone_norm", normalizedValue(ContactNormalizer::phone(*patch.phone)));
+    }
+
+    if (!database.transaction()) {
+        setError(error, "Failed to begin transaction: " + database.lastError().text());
+        return false;
+    }
+
+    QVector<Contact> rows;
+    if (!stageIds(database, ids, &rows, error)) {
+        database.rollback();
+        return false;
+    }
+
+    if (!assignments.isEmpty()) {
+        QSqlQuery query(database);
+        query.prepare("UPDATE contacts SET " + assignments.join(", ") + " "
+                      "WHERE id IN (SELECT id FROM temp.bulk_ids)");
+        for (auto it = values.cbegin(); it != values.cend(); ++it) {
+            query.bindValue(it.key(), it.value());
+        }
+        if (!query.exec()) {
+            setError(error, "Failed to update contacts: " + query.lastError().text());
+            database.rollback();
+            return false;
+        }
+    }
+
+    if (!database.commit()) {
+        setError(error, "Failed to commit update: " + database.lastError().text());
+        database.rollback();
+        return false;
+    }
+
+    *previous = rows;
+    return true;
+}
+
+bool SqliteStorageEngine::applyWrites(QVector<ContactWrite> *writes, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    // Reads go through the writing connection so that they see the
+    // batch's own uncommitted rows
+    QSqlQuery insertQuery(database);
+    QSqlQuery updateQuery(database);
+    QSqlQuery deleteQuery(database);
+    QSqlQuery selectQuery(database);
+    selectQuery.setForwardOnly(true);
+    if (!prepareInsert(insertQuery)
+        || !updateQuery.prepare("UPDATE contacts SET first_name=:firstName, last_name=:lastName, "
+                                "email=:email, phone=:phone, city=:city, country=:country, "
+                                "email_norm=:emailNorm, phone_norm=:phoneNorm "
+                                "WHERE id=:id")
+        || !deleteQuery.prepare("DELETE FROM contacts WHERE id=:id")
+        || !selectQuery.prepare("SELECT " + ContactColumns + " FROM contacts WHERE id=:id")) {
+        setError(error, "Failed to prepare writes: " + database.lastError().text());
+        return false;
+    }
+
+    if (!database.transaction()) {
+        setError(error, "Failed to begin transaction: " + database.lastError().text());
+        return false;
+    }
+
+    auto fail = [&](const QString &message, const QSqlQuery &query) {
+        setError(error, message + query.lastError().text());
+        database.rollback();
+        return false;
+    };
+
+    for (ContactWrite &write : *writes) {
+        write.applied = false;
+
+        if (write.kind == ContactWrite::Insert) {
+            bindInsert(insertQuery, write.contact);
+            if (!insertQuery.exec()) return fail("Failed to add contact: ", insertQuery);
+            write.contact.id = insertQuery.lastInsertId().toInt();
+            write.applied = true;
+            continue;
+        }
+
+        selectQuery.bindValue(":id", write.contact.id);
+        if (!selectQuery.exec()) return fail("Failed to load contact: ", selectQuery);
+        const bool found = selectQuery.next();
+        if (found) hydrateContact(selectQuery, &write.previous);
+        selectQuery.finish();
+        if (!found) continue;
+
+        if (write.kind == ContactWrite::Update) {
+            updateQuery.bindValue(":id", write.contact.id);
+            bindInsert(updateQuery, write.contact);
+            if (!updateQuery.exec()) return fail("Failed to update contact: ", updateQuery);
+        } else {
+            deleteQuery.bindValue(":id", write.contact.id);
+            if (!deleteQuery.exec()) return fail("Failed to delete contact: ", deleteQuery);
+        }
+        write.applied = true;
+    }
+
+    if (!database.commit()) {
+        setError(error, "Failed to commit writes: " + database.lastError().text());
+        database.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::get(int id, Contact *contact, QString *error)
+{
+    // The native reader is single-threaded and belongs to the owner thread
+    if (nativeReadsActive() && onOwnerThread()) {
+        if (m_nativeReader->readContact(id, contact)) return true;
+        // A missing row leaves the error empty
+        if (!m_nativeReader->lastError().isEmpty()) {
+            setError(error, "Failed to fetch contact: " + m_nativeReader->lastError());
+        }
+        return false;
+    }
+
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT " + ContactColumns + " FROM contacts WHERE id=:id");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        setError(error, "Failed to fetch contact: " + query.lastError().text());
+        return false;
+    }
+    if (!query.next()) {
+        return false;
+    }
+
+    hydrateContact(query, contact);
+    return true;
+}
+
+bool SqliteStorageEngine::getAll(QVector<Contact> *contacts, QString *error)
+{
+    if (nativeReadsActive() && onOwnerThread()) {
+        if (!m_nativeReader->readAll(contacts)) {
+            setError(error, "Failed to fetch contacts: " + m_nativeReader->lastError());
+            return false;
+        }
+        return true;
+    }
+
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT " + ContactColumns + " FROM contacts ORDER BY first_name, last_name, id")) {
+        setError(error, "Failed to fetch contacts: " + query.lastError().text());
+        return false;
+    }
+
+    while (query.next()) {
+        contacts->append(Contact());
+        hydrateContact(query, &contacts->last());
+    }
+    return true;
+}
+
+int SqliteStorageEngine::count(QString *error)
+{
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return -1;
+
+    QSqlQuery query(database);
+    if (!query.exec("SELECT COUNT(*) FROM contacts") || !query.next()) {
+        setError(error, "Failed to count contacts: " + query.lastError().text());
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool SqliteStorageEngine::forEach(const std::function<bool(const Contact &)> &visitor,
+                                  QString *error)
+{
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    // Forward-only keeps QtSql from caching rows it has already returned
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT " + ContactColumns + " FROM contacts ORDER BY first_name, last_name, id")) {
+        setError(error, "Failed to read contacts: " + query.lastError().text());
+        return false;
+    }
+
+    Contact contact;
+    while (query.next()) {
+        hydrateContact(query, &contact);
+        if (!visitor(contact)) return true;
+    }
+
+    // next() also returns false when the scan fails partway through
+    if (query.lastError().isValid()) {
+        setError(error, "Failed to read contacts: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::page(const Contact &after, int limit, QVector<Contact> *contacts,
+                               QString *error)
+{
+    if (nativeReadsActive() && onOwnerThread()) {
+        if (!m_nativeReader->readPage(after, limit, contacts)) {
+            setError(error, "Failed to fetch contacts page: " + m_nativeReader->lastError());
+            return false;
+        }
+        return true;
+    }
+
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (after.id < 0) {
+        query.prepare("SELECT " + ContactColumns + " "
+                     "FROM contacts ORDER BY first_name, last_name, id LIMIT :limit");
+    } else {
+        query.prepare("SELECT " + ContactColumns + " "
+                     "FROM contacts "
+                     "WHERE (first_name, last_name, id) > (:firstName, :lastName, :id) "
+                     "ORDER BY first_name, last_name, id LIMIT :limit");
+        query.bindValue(":firstName", after.firstName);
+        query.bindValue(":lastName", after.lastName);
+        query.bindValue(":id", after.id);
+    }
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        setError(error, "Failed to fetch contacts page: " + query.lastError().text());
+        return false;
+    }
+
+    contacts->reserve(contacts->size() + limit);
+    while (query.next()) {
+        contacts->append(Contact());
+        hydrateContact(query, &contacts->last());
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::findByColumn(const QString &column, const QStringList &keys,
+                                       QVector<Contact> *contacts, QString *error)
+{
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    // One prepared statement serves the whole batch; each key is an index probe
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.prepare("SELECT " + ContactColumns + " FROM contacts WHERE " + column + " = :key")) {
+        setError(error, "Failed to prepare lookup: " + query.lastError().text());
+        return false;
+    }
+
+    for (const QString &key : keys) {
+        query.bindValue(":key", key);
+        if (!query.exec()) {
+            setError(error, "Failed to look up contacts: " + query.lastError().text());
+            return false;
+        }
+        while (query.next()) {
+            contacts->append(Contact());
+            hydrateContact(query, &contacts->last());
+        }
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::findByEmail(const QStringList &emails, QVector<Contact> *contacts,
+                                      QString *error)
+{
+    QStringList keys;
+    for (const QString &email : emails) {
+        const QString key = ContactNormalizer::email(email);
+        if (!key.isEmpty()) keys.append(key);
+    }
+    keys.removeDuplicates();
+    return findByColumn("email_norm", keys, contacts, error);
+}
+
+bool SqliteStorageEngine::findByPhone(const QStringList &phones, QVector<Contact> *contacts,
+                                      QString *error)
+{
+    QStringList keys;
+    for (const QString &phone : phones) {
+        const QString key = ContactNormalizer::phone(phone);
+        if (!key.isEmpty()) keys.append(key);
+    }
+    keys.removeDuplicates();
+    return findByColumn("phone_norm", keys, contacts, error);
+}
+
+// ============= Facets =============
+
+bool SqliteStorageEngine::facetCounts(ContactFacet facet, QVector<FacetCount> *counts,
+                                      QString *error)
+{
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT value, count FROM contact_facets WHERE facet = :facet "
+                  "ORDER BY count DESC, value");
+    query.bindValue(":facet", int(facet));
+
+    if (!query.exec()) {
+        setError(error, "Failed to read facet counts: " + query.lastError().text());
+        return false;
+    }
+
+    while (query.next()) {
+        FacetCount count;
+        count.value = query.value(0).toString();
+        count.count = query.value(1).toInt();
+        counts->append(count);
+    }
+    return true;
+}
+
+bool SqliteStorageEngine::findByFacet(ContactFacet facet, const QString &value, int limit,
+                                      QVector<Contact> *contacts, QString *error)
+{
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    const QString column = facet == CountryFacet ? "country" : "city";
+    // '' stands for both NULL and empty, which cannot share one index probe
+    const QString condition = value.isEmpty()
+        ? "(" + column + " IS NULL OR " + column + " = '')"
+        : column + " = :value";
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT " + ContactColumns + " FROM contacts WHERE " + condition + " "
+                  "ORDER BY first_name, last_name, id LIMIT :limit");
+    if (!value.isEmpty()) {
+        query.bindValue(":value", value);
+    }
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        setError(error, "Failed to filter contacts: " + query.lastError().text());
+        return false;
+    }
+
+    while (query.next()) {
+        contacts->append(Contact());
+        hydrateContact(query, &contacts->last());
+    }
+    return true;
+}
+
+// ============= Change log =============
+
+bool SqliteStorageEngine::changesSince(qint64 sequence, int limit, QVector<ContactChange> *changes,
+                                       QString *error)
+{
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    // Contact columns first so hydrateContact() can read them by position
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT k.id, k.first_name, k.last_name, k.email, k.phone, k.city, k.country, "
+                  "c.seq, c.op, c.contact_id "
+                  "FROM contact_changes c LEFT JOIN contacts k ON k.id = c.contact_id "
+                  "WHERE c.seq > :seq ORDER BY c.seq LIMIT :limit");
+    query.bindValue(":seq", sequence);
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        setError(error, "Failed to read changes: " + query.lastError().text());
+        return false;
+    }
+
+    while (query.next()) {
+        changes->append(ContactChange());
+        ContactChange &change = changes->last();
+        change.sequence = query.value(7).toLongLong();
+        change.kind = ContactChange::Kind(query.value(8).toInt());
+        change.contactId = query.value(9).toInt();
+        if (!query.isNull(0)) {
+            hydrateContact(query, &change.contact);
+        }
+    }
+    return true;
+}
+
+int SqliteStorageEngine::compactChanges(qint64 sequence, QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return -1;
+
+    // A consumer only needs the newest change of each contact; older ones
+    // up to 'sequence' go. The (contact_id, seq) index answers the MAX.
+    QSqlQuery query(database);
+    query.prepare("DELETE FROM contact_changes WHERE seq <= :seq AND seq < "
+                  "(SELECT MAX(seq) FROM contact_changes newer "
+                  "WHERE newer.contact_id = contact_changes.contact_id)");
+    query.bindValue(":seq", sequence);
+
+    if (!query.exec()) {
+        setError(error, "Failed to compact changes: " + query.lastError().text());
+        return -1;
+    }
+    return query.numRowsAffected();
+}
+
+bool SqliteStorageEngine::compact(QString *error)
+{
+    QSqlDatabase database = connection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    if (m_ftsAvailable
+        && !query.exec("INSERT INTO contacts_fts(contacts_fts) VALUES('optimize')")) {
+        setError(error, "Failed to optimize search index: " + query.lastError().text());
+        return false;
+    }
+
+    // VACUUM rewrites the main file; the checkpoint then empties the WAL
+    const char *const statements[] = {
+        "VACUUM",
+        "PRAGMA wal_checkpoint(TRUNCATE)",
+        "PRAGMA optimize"
+    };
+    for (const char *statement : statements) {
+        if (!query.exec(statement)) {
+            setError(error, QString("%1 failed: %2").arg(statement, query.lastError().text()));
+            return false;
+        }
+        query.finish();
+    }
+    return true;
+}
+
+QString SqliteStorageEngine::buildFtsQuery(const QString &searchTerm)
+{
+    // Each token becomes a quoted prefix phrase; FTS5 ANDs adjacent phrases
+    QStringList phrases;
+    const QStringList tokens = searchTerm.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    for (QString token : tokens) {
+        token.remove('"');
+        if (!token.isEmpty()) {
+            phrases.append(QStringLiteral("\"") + token + QStringLiteral("\"*"));
+        }
+    }
+    return phrases.join(' ');
+}
+
+bool SqliteStorageEngine::search(const QString &searchTerm, int limit, QVector<Contact> *contacts,
+                                 QString *error, const std::function<bool()> &isCancelled)
+{
+    const bool fullText = m_ftsAvailable;
+    QString ftsQuery = fullText ? buildFtsQuery(searchTerm) : QString();
+    if (fullText && ftsQuery.isEmpty()) {
+        return true;
+    }
+
+    QSqlDatabase database = readConnection(error);
+    if (!database.isOpen()) return false;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (fullText) {
+        query.prepare("SELECT c.id, c.first_name, c.last_name, c.email, c.phone, c.city, c.country "
+                     "FROM contacts_fts "
+                     "JOIN contacts c ON c.id = contacts_fts.rowid "
+                     "WHERE contacts_fts MATCH :query "
+                     "ORDER BY contacts_fts.rank, c.first_name, c.last_name "
+                     "LIMIT :limit");
+        query.bindValue(":query", ftsQuery);
+    } else {
+        query.prepare("SELECT " + ContactColumns + " FROM contacts WHERE "
+                     "first_name LIKE :term OR last_name LIKE :term OR "
+                     "email LIKE :term OR phone LIKE :term OR "
+                     "city LIKE :term OR country LIKE :term "
+                     "ORDER BY first_name, last_name "
+                     "LIMIT :limit");
+        query.bindValue(":term", "%" + searchTerm + "%");
+    }
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        setError(error, "Failed to search contacts: " + query.lastError().text());
+        return false;
+    }
+
+    int rows = 0;
+    while (query.next()) {
+        // Polling every few hundred rows keeps cancellation cheap
+        if (isCancelled && (++rows % 256) == 0 && isCancelled()) {
+            contacts->clear();
+            return true;
+        }
+
+        contacts->append(Contact());
+        hydrateContact(query, &contacts->last());
+    }
+
+    return true;
+}
@@ -0,0 +1,131 @@
+#ifndef SQLITESTORAGEENGINE_H
+#define SQLITESTORAGEENGINE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include "storageengine.h"
+
+class ConnectionPool;
+class NativeContactReader;
+class QSqlQuery;
+class SchemaMigrator;
+class QThread;
+
+/**
+ * @brief StorageEngine backed by an SQLite file through QtSql
+ *
+ * The thread that calls open() uses the main connection; any other
+ * thread transparently gets its own pooled connection, read-only for
+ * queries and read-write for inserts and updates. The database runs in
+ * WAL mode so those connections do not block each other.
+ *
+ * Search goes through an FTS5 index when the SQLite build has it and
+ * falls back to LIKE otherwise. Reads on the owner thread can bypass
+ * QtSql through NativeContactReader (see setNativeReadsEnabled()).
+ */
+class SqliteStorageEngine : public StorageEngine
+{
+public:
+    explicit SqliteStorageEngine(const QString &databasePath = QStringLiteral("contacts.db"));
+    ~SqliteStorageEngine() override;
+
+    QString name() const override { return QStringLiteral("sqlite"); }
+    QString databasePath() const { return m_path; }
+
+    // Migrates the file and builds the search index on a throwaway
+    // connection owned by the calling thread
+    bool prepare(QString *error = nullptr) override;
+    bool open(QString *error = nullptr) override;
+    void close() override;
+    bool isOpen() const override { return m_open; }
+    bool createSchema(QString *error = nullptr) override;
+
+    bool insert(Contact *contact, QString *error = nullptr) override;
+    int insertBatch(const QVector<Contact> &contacts, QString *error = nullptr) override;
+    bool update(const Contact &contact, QString *error = nullptr) override;
+    bool remove(int id, QString *error = nullptr) override;
+    bool merge(const Contact &survivor, const QVector<int> &removedIds,
+               QString *error = nullptr) override;
+    // Ids are staged in a temporary table, then one statement does the work
+    bool removeMany(const QVector<int> &ids, QVector<Contact> *removed,
+                    QString *error = nullptr) override;
+    bool updateMany(const QVector<int> &ids, const ContactPatch &patch,
+                    QVector<Contact> *previous, QString *error = nullptr) override;
+    // One transaction with statements prepared once per batch
+    bool applyWrites(QVector<ContactWrite> *writes, QString *error = nullptr) override;
+
+    bool get(int id, Contact *contact, QString *error = nullptr) override;
+    bool getAll(QVector<Contact> *contacts, QString *error = nullptr) override;
+    int count(QString *error = nullptr) override;
+    // A single forward-only query; rows are hydrated one at a time
+    bool forEach(const std::function<bool(const Contact &)> &visitor,
+                 QString *error = nullptr) override;
+    bool page(const Contact &after, int limit, QVector<Contact> *contacts,
+              QString *error = nullptr) override;
+    bool search(const QString &searchTerm, int limit, QVector<Contact> *contacts,
+                QString *error = nullptr,
+                const std::function<bool()> &isCancelled = {}) override;
+    bool findByEmail(const QStringList &emails, QVector<Contact> *contacts,
+                     QString *error = nullptr) override;
+    bool findByPhone(const QStringList &phones, QVector<Contact> *contacts,
+                     QString *error = nullptr) override;
+    bool facetCounts(ContactFacet facet, QVector<FacetCount> *counts,
+                     QString *error = nullptr) override;
+    bool findByFacet(ContactFacet facet, const QString &value, int limit,
+                     QVector<Contact> *contacts, QString *error = nullptr) override;
+    bool changesSince(qint64 sequence, int limit, QVector<ContactChange> *changes,
+                      QString *error = nullptr) override;
+    int compactChanges(qint64 sequence, QString *error = nullptr) override;
+    // Merges the FTS segments, VACUUMs the file and truncates the WAL
+    bool compact(QString *error = nullptr) override;
+
+    bool hasFullTextSearch() const { return m_ftsAvailable; }
+
+    // Every schema change, in order; createSchema() applies the pending ones
+    static SchemaMigrator migrations();
+    // Runs EXPLAIN QUERY PLAN on the hot queries and returns a description
+    // of each one that no longer uses its covering index or needs a sort.
+    // Empty means every plan is as expected. Checked by tests/queryplan_test,
+    // not at startup.
+    QStringList verifyQueryPlans();
+
+    // Reads through the sqlite3 C API on the owner connection when built
+    // with it (see CONTACTMANAGER_NATIVE_SQLITE)
+    void setNativeReadsEnabled(bool enabled);
+    bool nativeReadsEnabled() const { return m_nativeReadsEnabled; }
+    bool nativeReadsActive() const;
+
+    // The calling thread's read-write connection; check isOpen() on the result
+    QSqlDatabase connection(QString *error = nullptr);
+    // The calling thread's connection for queries; read-only off the owner thread
+    QSqlDatabase readConnection(QString *error = nullptr);
+
+private:
+    // Fills temp.bulk_ids and reads the affected rows; runs inside the caller's transaction
+    static bool stageIds(QSqlDatabase &database, const QVector<int> &ids,
+                         QVector<Contact> *contacts, QString *error);
+    QString m_path;
+    QString m_connectionName;
+    QThread *m_ownerThread;
+    std::atomic<bool> m_open;
+    std::atomic<bool> m_ftsAvailable;
+    std::unique_ptr<NativeContactReader> m_nativeReader;
+    bool m_nativeReadsEnabled;
+    std::unique_ptr<ConnectionPool> m_readPool;
+    std::unique_ptr<ConnectionPool> m_writePool;
+
+    bool onOwnerThread() const;
+    void configureConnection(QSqlDatabase &database);
+    void openNativeReader();
+    bool createSearchIndex(QSqlDatabase &database);
+    bool findByColumn(const QString &column, const QStringList &keys,
+                      QVector<Contact> *contacts, QString *error);
+    static QString buildFtsQuery(const QString &searchTerm);
+    static bool prepareInsert(QSqlQuery &query);
+    static void bindInsert(QSqlQuery &query, const Contact &contact);
+};
+
+#endif // SQLITESTORAGEENGINE_H
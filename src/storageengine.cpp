@@ -0,0 +1,89 @@
+#include "storageengine.h"
+#include <utility>
+
+namespace {
+
+void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+} // namespace
+
+bool StorageEngine::prepare(QString *error)
+{
+    Q_UNUSED(error)
+    return true;
+}
+
+bool StorageEngine::applyWrites(QVector<ContactWrite> *writes, QString *error)
+{
+    for (ContactWrite &write : *writes) {
+        write.applied = false;
+        if (write.kind == ContactWrite::Insert) {
+            if (!insert(&write.contact, error)) return false;
+            write.applied = true;
+            continue;
+        }
+
+        QString lookupError;
+        if (!get(write.contact.id, &write.previous, &lookupError)) {
+            if (!lookupError.isEmpty()) {
+                setError(error, lookupError);
+                return false;
+            }
+            continue;
+        }
+
+        if (write.kind == ContactWrite::Update ? !update(write.contact, error)
+                                               : !remove(write.contact.id, error)) {
+            return false;
+        }
+        write.applied = true;
+    }
+    return true;
+}
+
+bool StorageEngine::changesSince(qint64 sequence, int limit, QVector<ContactChange> *changes,
+                                 QString *error)
+{
+    Q_UNUSED(sequence)
+    Q_UNUSED(limit)
+    Q_UNUSED(changes)
+    setError(error, "The " + name() + " engine does not keep a change log");
+    return false;
+}
+
+bool StorageEngine::compact(QString *error)
+{
+    Q_UNUSED(error)
+    return true;
+}
+
+int StorageEngine::compactChanges(qint64 sequence, QString *error)
+{
+    Q_UNUSED(sequence)
+    setError(error, "The " + name() + " engine does not keep a change log");
+    return -1;
+}
+
+bool StorageEngine::forEach(const std::function<bool(const Contact &)> &visitor, QString *error)
+{
+    QVector<Contact> page;
+    page.reserve(CursorPageSize);
+    Contact after;  // id -1: start from the first row
+
+    forever {
+        page.clear();
+        if (!this->page(after, CursorPageSize, &page, error)) {
+            return false;
+        }
+
+        for (const Contact &contact : std::as_const(page)) {
+            if (!visitor(contact)) return true;
+        }
+
+        if (page.size() < CursorPageSize) return true;
+        after = page.last();
+    }
+}
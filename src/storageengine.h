@@ -0,0 +1,159 @@
+#ifndef STORAGEENGINE_H
+#define STORAGEENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "contact.h"
+
+/**
+ * @brief One queued mutation for StorageEngine::applyWrites()
+ */
+struct ContactWrite {
+    enum Kind {
+        Insert,
+        Update,
+        Remove
+    };
+
+    Kind kind = Insert;
+    Contact contact;      // Remove only uses the id; Insert gets the new id
+    // Filled in by applyWrites()
+    Contact previous;     // the row before an Update or Remove
+    bool applied = false; // false if the row to update or remove was missing
+};
+
+/**
+ * @brief One entry of the change log read by StorageEngine::changesSince()
+ */
+struct ContactChange {
+    enum Kind {
+        Inserted = 1,
+        Updated = 2,
+        Deleted = 3
+    };
+
+    qint64 sequence = 0;
+    Kind kind = Inserted;
+    int contactId = -1;
+    // The row as it is now; left empty (id -1) once it has been deleted
+    Contact contact;
+};
+
+// Low-cardinality columns with maintained per-value counts
+enum ContactFacet {
+    CountryFacet = 0,
+    CityFacet = 1
+};
+
+struct FacetCount {
+    QString value;    // empty for contacts without one
+    int count = 0;
+};
+
+/**
+ * @brief Storage backend behind DatabaseManager
+ *
+ * DatabaseManager keeps validation, caching and signals; an engine only
+ * stores and retrieves rows. Every method may be called from any thread
+ * once open() has returned, so background workers (search, import) talk
+ * to the engine directly. Methods report failures by returning false (or
+ * -1 for counts) and filling in *error when it is non-null.
+ *
+ * Rows are ordered by (first_name, last_name, id) wherever an order is
+ * implied.
+ */
+class StorageEngine
+{
+public:
+    // Page size used by the default forEach()
+    static constexpr int CursorPageSize = 1024;
+
+    virtual ~StorageEngine() = default;
+
+    virtual QString name() const = 0;
+
+    // Slow start-up work that does not tie the engine to a thread (schema
+    // upgrades, index builds, log replay). May run on a worker thread before
+    // open() so that open() and createSchema() are quick on the GUI thread.
+    // The default does nothing.
+    virtual bool prepare(QString *error = nullptr);
+    virtual bool open(QString *error = nullptr) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    // Creates or upgrades whatever the engine needs before use
+    virtual bool createSchema(QString *error = nullptr) = 0;
+
+    // Assigns contact->id on success
+    virtual bool insert(Contact *contact, QString *error = nullptr) = 0;
+    // All-or-nothing; invalid contacts are skipped. Returns rows inserted or -1.
+    virtual int insertBatch(const QVector<Contact> &contacts, QString *error = nullptr) = 0;
+    virtual bool update(const Contact &contact, QString *error = nullptr) = 0;
+    virtual bool remove(int id, QString *error = nullptr) = 0;
+    // Stores 'survivor' and deletes every id in removedIds, all or nothing
+    virtual bool merge(const Contact &survivor, const QVector<int> &removedIds,
+                       QString *error = nullptr) = 0;
+    // Set-based bulk operations, each one atomic step. Ids that do not
+    // exist are ignored; the affected rows are returned as they were
+    // before the change, in sort order.
+    virtual bool removeMany(const QVector<int> &ids, QVector<Contact> *removed,
+                            QString *error = nullptr) = 0;
+    virtual bool updateMany(const QVector<int> &ids, const ContactPatch &patch,
+                            QVector<Contact> *previous, QString *error = nullptr) = 0;
+    // Applies the writes in order as one atomic commit. Updates and removes
+    // of missing rows are skipped rather than failing the batch. The default
+    // applies them one by one, without atomicity.
+    virtual bool applyWrites(QVector<ContactWrite> *writes, QString *error = nullptr);
+
+    // Returns false if the row does not exist (error stays empty) or on failure
+    virtual bool get(int id, Contact *contact, QString *error = nullptr) = 0;
+    virtual bool getAll(QVector<Contact> *contacts, QString *error = nullptr) = 0;
+    // Number of stored contacts, or -1 on error
+    virtual int count(QString *error = nullptr) = 0;
+    // Calls visitor for every contact in sort order without holding them
+    // all in memory; stops early (still succeeding) once visitor returns
+    // false. The default walks keyset pages.
+    virtual bool forEach(const std::function<bool(const Contact &)> &visitor,
+                         QString *error = nullptr);
+    // Keyset page after 'after' (id < 0 for the first page)
+    virtual bool page(const Contact &after, int limit, QVector<Contact> *contacts,
+                      QString *error = nullptr) = 0;
+    // Prefix match on every whitespace-separated token, best matches
+    // first. A negative limit returns all matches. A cancelled search
+    // succeeds with no rows.
+    virtual bool search(const QString &searchTerm, int limit, QVector<Contact> *contacts,
+                        QString *error = nullptr,
+                        const std::function<bool()> &isCancelled = {}) = 0;
+    // Exact match on the normalized value (see ContactNormalizer); keys are
+    // normalized by the engine, so "+1 (555) 010-2000" finds "5550102000".
+    // Matches for every key are appended in key order.
+    virtual bool findByEmail(const QStringList &emails, QVector<Contact> *contacts,
+                             QString *error = nullptr) = 0;
+    virtual bool findByPhone(const QStringList &phones, QVector<Contact> *contacts,
+                             QString *error = nullptr) = 0;
+
+    // Contacts per distinct value of the facet column, largest first. The
+    // counts are maintained on every write, so this never scans contacts.
+    virtual bool facetCounts(ContactFacet facet, QVector<FacetCount> *counts,
+                             QString *error = nullptr) = 0;
+    // Up to 'limit' contacts (negative for all) whose facet column equals
+    // 'value', in sort order, through an index on that column
+    virtual bool findByFacet(ContactFacet facet, const QString &value, int limit,
+                             QVector<Contact> *contacts, QString *error = nullptr) = 0;
+
+    // Change log: every insert, update and delete gets an increasing
+    // sequence number. Engines without one (the default) fail both calls.
+    // Up to 'limit' changes after 'sequence', oldest first
+    virtual bool changesSince(qint64 sequence, int limit, QVector<ContactChange> *changes,
+                              QString *error = nullptr);
+    // Drops every change up to 'sequence' that a later change of the same
+    // contact supersedes; returns the number removed or -1
+    virtual int compactChanges(qint64 sequence, QString *error = nullptr);
+
+    // Gives back space left by deleted and rewritten rows. Can take a while
+    // and blocks writers meanwhile. The default does nothing.
+    virtual bool compact(QString *error = nullptr);
+};
+
+#endif // STORAGEENGINE_H
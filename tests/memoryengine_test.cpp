@@ -0,0 +1,244 @@
+// Exercises the durability log of MemoryStorageEngine: replay, dropping a
+// torn final record, all-or-nothing batch records and compaction on open.
+
+#include "memorystorageengine.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+Contact makeContact(const QString &firstName, const QString &lastName)
+{
+    Contact contact;
+    contact.firstName = firstName;
+    contact.lastName = lastName;
+    contact.email = firstName.toLower() + "@example.com";
+    contact.city = "Berlin";
+    contact.country = "Germany";
+    return contact;
+}
+
+qint64 fileSize(const QString &path)
+{
+    return QFileInfo(path).size();
+}
+
+// Cuts the file off halfway into its last record
+bool tearLastRecord(const QString &path, qint64 recordStart)
+{
+    const qint64 size = fileSize(path);
+    return size > recordStart && QFile::resize(path, recordStart + (size - recordStart) / 2);
+}
+
+} // namespace
+
+class MemoryEngineTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void memoryOnly();
+    void replay();
+    void tornTailIsDropped();
+    void tornBatchIsDroppedWhole();
+    void tornMergeIsDroppedWhole();
+    void compactsOnOpen();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_logPath;
+};
+
+void MemoryEngineTest::init()
+{
+    QVERIFY(m_dir.isValid());
+    m_logPath = m_dir.filePath(QString("%1.log").arg(QTest::currentTestFunction()));
+}
+
+void MemoryEngineTest::memoryOnly()
+{
+    MemoryStorageEngine engine;
+    QVERIFY(engine.open());
+
+    Contact contact = makeContact("Maria", "Garcia");
+    QVERIFY(engine.insert(&contact));
+    QCOMPARE(engine.count(), 1);
+
+    engine.close();
+    QVERIFY(engine.open());
+    QCOMPARE(engine.count(), 0);
+}
+
+void MemoryEngineTest::replay()
+{
+    Contact maria = makeContact("Maria", "Garcia");
+    Contact wei = makeContact("Wei", "Chen");
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QVERIFY(engine.insert(&maria));
+        QVERIFY(engine.insert(&wei));
+
+        maria.city = "Madrid";
+        QVERIFY(engine.update(maria));
+        QVERIFY(engine.remove(wei.id));
+    }
+
+    MemoryStorageEngine engine(m_logPath);
+    QVERIFY(engine.open());
+    QCOMPARE(engine.count(), 1);
+
+    Contact stored;
+    QVERIFY(engine.get(maria.id, &stored));
+    QCOMPARE(stored.city, QString("Madrid"));
+    QVERIFY(!engine.get(wei.id, &stored));
+}
+
+void MemoryEngineTest::tornTailIsDropped()
+{
+    Contact maria = makeContact("Maria", "Garcia");
+    Contact wei = makeContact("Wei", "Chen");
+    Contact fatima = makeContact("Fatima", "Khan");
+    qint64 goodSize = 0;
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QVERIFY(engine.insert(&maria));
+        QVERIFY(engine.insert(&wei));
+        goodSize = fileSize(m_logPath);
+        QVERIFY(engine.insert(&fatima));
+    }
+    QVERIFY(tearLastRecord(m_logPath, goodSize));
+
+    Contact sofia = makeContact("Sofia", "Rossi");
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QCOMPARE(engine.count(), 2);
+        QCOMPARE(fileSize(m_logPath), goodSize);
+
+        Contact stored;
+        QVERIFY(engine.get(maria.id, &stored));
+        QVERIFY(engine.get(wei.id, &stored));
+        QVERIFY(!engine.get(fatima.id, &stored));
+
+        // Appends start on the record boundary the torn record left behind
+        QVERIFY(engine.insert(&sofia));
+    }
+
+    MemoryStorageEngine engine(m_logPath);
+    QVERIFY(engine.open());
+    QCOMPARE(engine.count(), 3);
+
+    Contact stored;
+    QVERIFY(engine.get(sofia.id, &stored));
+    QCOMPARE(stored.lastName, QString("Rossi"));
+}
+
+void MemoryEngineTest::tornBatchIsDroppedWhole()
+{
+    Contact maria = makeContact("Maria", "Garcia");
+    Contact wei = makeContact("Wei", "Chen");
+    qint64 goodSize = 0;
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QVERIFY(engine.insert(&maria));
+        QVERIFY(engine.insert(&wei));
+        goodSize = fileSize(m_logPath);
+
+        ContactWrite insert;
+        insert.contact = makeContact("Fatima", "Khan");
+        ContactWrite update;
+        update.kind = ContactWrite::Update;
+        update.contact = maria;
+        update.contact.city = "Madrid";
+        ContactWrite remove;
+        remove.kind = ContactWrite::Remove;
+        remove.contact.id = wei.id;
+
+        QVector<ContactWrite> writes{insert, update, remove};
+        QVERIFY(engine.applyWrites(&writes));
+        QCOMPARE(engine.count(), 2);
+    }
+    QVERIFY(tearLastRecord(m_logPath, goodSize));
+
+    MemoryStorageEngine engine(m_logPath);
+    QVERIFY(engine.open());
+    QCOMPARE(engine.count(), 2);
+
+    Contact stored;
+    QVERIFY(engine.get(maria.id, &stored));
+    QCOMPARE(stored.city, QString("Berlin"));
+    QVERIFY(engine.get(wei.id, &stored));
+}
+
+void MemoryEngineTest::tornMergeIsDroppedWhole()
+{
+    Contact maria = makeContact("Maria", "Garcia");
+    Contact duplicate = makeContact("Maria", "Garcia");
+    qint64 goodSize = 0;
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QVERIFY(engine.insert(&maria));
+        QVERIFY(engine.insert(&duplicate));
+        goodSize = fileSize(m_logPath);
+
+        Contact survivor = maria;
+        survivor.phone = "+34 600 000 000";
+        QVERIFY(engine.merge(survivor, {duplicate.id}));
+        QCOMPARE(engine.count(), 1);
+    }
+    QVERIFY(tearLastRecord(m_logPath, goodSize));
+
+    MemoryStorageEngine engine(m_logPath);
+    QVERIFY(engine.open());
+    QCOMPARE(engine.count(), 2);
+
+    Contact stored;
+    QVERIFY(engine.get(maria.id, &stored));
+    QVERIFY(stored.phone.isEmpty());
+    QVERIFY(engine.get(duplicate.id, &stored));
+}
+
+void MemoryEngineTest::compactsOnOpen()
+{
+    Contact maria = makeContact("Maria", "Garcia");
+    qint64 fullSize = 0;
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QVERIFY(engine.insert(&maria));
+        // Far more entries than live rows
+        for (int i = 0; i < 2000; ++i) {
+            maria.phone = QString::number(i);
+            QVERIFY(engine.update(maria));
+        }
+        fullSize = fileSize(m_logPath);
+    }
+
+    qint64 snapshotSize = 0;
+    {
+        MemoryStorageEngine engine(m_logPath);
+        QVERIFY(engine.open());
+        QCOMPARE(engine.count(), 1);
+        snapshotSize = fileSize(m_logPath);
+        QVERIFY(snapshotSize < fullSize / 100);
+    }
+
+    MemoryStorageEngine engine(m_logPath);
+    QVERIFY(engine.open());
+    QCOMPARE(fileSize(m_logPath), snapshotSize);
+
+    Contact stored;
+    QVERIFY(engine.get(maria.id, &stored));
+    QCOMPARE(stored.phone, QString("1999"));
+}
+
+QTEST_GUILESS_MAIN(MemoryEngineTest)
+#include "memoryengine_test.moc"
@@ -0,0 +1,89 @@
+// Checks that the hot queries keep their covering indexes, both on a new
+// database and on one migrated up from the first schema version.
+
+#include "schemamigrator.h"
+#include "sqlitestorageengine.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class QueryPlanTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void freshDatabase();
+    void versionOneDatabase();
+
+private:
+    QTemporaryDir m_dir;
+
+    static void verifySchema(SqliteStorageEngine &engine);
+};
+
+void QueryPlanTest::verifySchema(SqliteStorageEngine &engine)
+{
+    QString error;
+    QVERIFY2(engine.open(&error), qPrintable(error));
+    QVERIFY2(engine.createSchema(&error), qPrintable(error));
+
+    QCOMPARE(SchemaMigrator::currentVersion(engine.connection()),
+             SqliteStorageEngine::migrations().latestVersion());
+
+    const QStringList problems = engine.verifyQueryPlans();
+    QVERIFY2(problems.isEmpty(), qPrintable(problems.join('\n')));
+}
+
+void QueryPlanTest::freshDatabase()
+{
+    QVERIFY(m_dir.isValid());
+
+    SqliteStorageEngine engine(m_dir.filePath("fresh.db"));
+    verifySchema(engine);
+}
+
+void QueryPlanTest::versionOneDatabase()
+{
+    QVERIFY(m_dir.isValid());
+    const QString path = m_dir.filePath("version1.db");
+
+    // The contacts table as migration 1 left it, with a row to carry over
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "version1");
+        database.setDatabaseName(path);
+        QVERIFY2(database.open(), qPrintable(database.lastError().text()));
+
+        QSqlQuery query(database);
+        QVERIFY2(query.exec(R"(
+            CREATE TABLE contacts (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                first_name TEXT NOT NULL,
+                last_name TEXT NOT NULL,
+                email TEXT,
+                phone TEXT,
+                city TEXT,
+                country TEXT,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )
+        )"), qPrintable(query.lastError().text()));
+        QVERIFY(query.exec("INSERT INTO contacts (first_name, last_name, email, phone, city, country) "
+                           "VALUES ('Maria', 'Garcia', 'Maria@Example.com', '+1 555 0100', "
+                           "'Madrid', 'Spain')"));
+        QVERIFY(query.exec("PRAGMA user_version = 1"));
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("version1");
+
+    SqliteStorageEngine engine(path);
+    verifySchema(engine);
+
+    QSqlQuery query(engine.connection());
+    QVERIFY(query.exec("SELECT COUNT(*) FROM contacts"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 1);
+}
+
+QTEST_GUILESS_MAIN(QueryPlanTest)
+#include "queryplan_test.moc"